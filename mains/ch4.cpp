@@ -5,8 +5,10 @@
  * Ch 4. Bridging with a virtual constructor
  */
 
+#include <cmath>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "../src/simspot.h"
 #include "../src/vanillaoption.h"
@@ -67,6 +69,28 @@ int main()
 
     std::cout << "the price is: " << doMonteCarlo(option, sigma, r, S0, nScen) << "\n";
     std::cout << "the price is: " << doMonteCarloP(option, ParametersConstant{sigma}, ParametersConstant{r}, S0, nScen) << "\n";
+    // a volatility falling over the option's life
+    ParametersPiecewiseLinear sigmaTerm{{0.0, T}, {1.2 * sigma, 0.8 * sigma}};
+    std::cout << "the price with a term structure is: " << doMonteCarloP(option, sigmaTerm, ParametersConstant{r}, S0, nScen) << "\n";
+
+    // monthly pillars queried month after month, as by an engine's pre-calculation: the lookups are to hit the hint
+    size_t nMonths = static_cast<size_t>(std::ceil(12.0 * T));
+    std::vector<double> months(nMonths);
+    std::vector<double> monthlyVols(nMonths);
+    for (size_t i = 0; i < nMonths; ++i)
+    {
+        months[i] = (i + 1) / 12.0;
+        monthlyVols[i] = sigma * (1.0 + 0.1 * std::sin(months[i]));
+    }
+    ParametersPiecewiseConstant sigmaMonthly{months, monthlyVols};
+
+    double variance = 0.0;
+    for (size_t i = 0; i < nMonths; ++i)
+    {
+        variance += sigmaMonthly.integralSquare(i > 0 ? months[i - 1] : 0.0, months[i]);
+    }
+    std::cout << "the monthly total variance is: " << variance << ", with " << sigmaMonthly.searches() << " binary searches in "
+              << 2 * nMonths << " lookups\n";
 
     return 0;
 }
@@ -5,8 +5,10 @@
  * Ch. 5: Strategies, decoration, and statistics.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/io.h"
 
@@ -18,15 +20,20 @@ using namespace der;
 
 auto doMonteCarlo(const VanillaOption & option, const Parameters & sigma, const Parameters & r, double S0, int nScen, StatisticsBase & gatherer)
 {
-    const simSpotParams spot{S0, option.expiry(), sigma, r};
+    simSpotParamsMultiple<> spot{S0, option.expiry(), sigma, r};
     auto discount = std::exp(-r.integral(0, option.expiry()));
 
-    for (int i = 0; i < nScen; ++i)
+    // the paths are simulated, paid off & gathered in batches, a call each; the batch's storage is reused
+    constexpr int batchSize = 1 << 14;
+    std::vector<double> batch;
+
+    for (int done = 0; done < nScen; done += batchSize)
     {
-        // payoff in the current path, spot() simulates a spot value @expiry
-        auto thisPayoff = option.optionPayoff(spot());
-        // add it to the sum
-        gatherer.dumpOneResult(discount * thisPayoff);
+        batch.resize(std::min(batchSize, nScen - done));
+        // spot values @expiry, then the discounted payoffs in their place
+        batch = spot.simSpotMultiple(std::move(batch));
+        option.optionPayoffs(batch, discount, batch);
+        gatherer.dumpResults(batch);
     }
 
     return gatherer.resultsSoFar();
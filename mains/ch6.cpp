@@ -16,6 +16,7 @@
 #include "common/io.h"
 
 #include "../src/random.h"
+#include "../src/samplesink.h"
 #include "../src/simspot.h"
 #include "../src/statistics.h"
 #include "../src/vanillaoption.h"
@@ -44,13 +45,9 @@ auto doMonteCarlo(const VanillaOption & option, const Parameters & sigma, const
     std::vector<double> simSpots = spot.simSpotMultiple(nScen);
     double discount = std::exp(-r.integral(0, option.expiry()));
 
-    for (auto & spotInst : simSpots)
-    {
-        // payoff in the current path
-        double thisPayoff = option.optionPayoff(spotInst);
-        // add it to the sum
-        gatherer.dumpOneResult(discount * thisPayoff);
-    }
+    // the discounted payoffs in place of the spots, gathered in one go
+    option.optionPayoffs(simSpots, discount, simSpots);
+    gatherer.dumpResults(simSpots);
 
     return gatherer.resultsSoFar();
 }
@@ -97,6 +94,12 @@ int main()
     std::cin >> S0 >> K >> T >> sigma >> r >> nScen;
 #endif
 
+#ifdef DUMPRESULTS
+    std::filesystem::create_directories("../data");
+    SampleSink::enable(SampleSink::Channel::Uniforms, "../data/uniforms.npy");
+    SampleSink::enable(SampleSink::Channel::Gaussians, "../data/gaussians.npy");
+#endif
+
     VanillaOption option{PayoffCall{K}, T};
     StatisticsMean gathererInner{};
 
@@ -144,6 +147,9 @@ int main()
     dumpResults(results2, "PM-AT");
     dumpResults(results3, "MT");
     dumpResults(results4, "MT-AT");
+
+    SampleSink::disable(SampleSink::Channel::Uniforms);
+    SampleSink::disable(SampleSink::Channel::Gaussians);
 #endif
 
     return 0;
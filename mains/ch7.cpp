@@ -5,8 +5,13 @@
  * Ch. 7: An exotics engine and the template pattern.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <numeric>
 #include <sstream>
+#include <string>
 
 // common libraries
 #include "common/io.h"
@@ -15,6 +20,44 @@
 #include "../src/exoticengine.h"
 #include "../src/pathdependent.h"
 #include "../src/payoff.h"
+#include "../src/randomasync.h"
+#include "../src/randommapped.h"
+#include "../src/scenario.h"
+#include "../src/staticengine.h"
+
+#ifdef TESTING
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// counts the heap allocations, c.f. the check in main
+namespace
+{
+std::atomic<size_t> g_allocations{0};
+}
+
+void * operator new(std::size_t p_size)
+{
+    ++g_allocations;
+    if (void * ret = std::malloc(p_size > 0 ? p_size : 1))
+    {
+        return ret;
+    }
+    throw std::bad_alloc();
+}
+
+// NOTE: GCC flags the free of what it takes for the built-in operator new, once these are inlined
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void * p_ptr) noexcept { std::free(p_ptr); }
+
+void operator delete(void * p_ptr, std::size_t) noexcept { std::free(p_ptr); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
 
 using namespace der;
 
@@ -73,5 +116,314 @@ int main()
     std::cout << "the results are: " << results << "\n\n";
     std::cout << "Anti-thetic results are: " << resultsat << "\n\n";
 
+    // the same, with the process, the product and the payoff all resolved at compile time
+    Engine<BSProcess, StaticAsianOptionArith<PayoffCall>, decltype(generator)> engineStatic({dates, T, payoff}, rP, dP, sigmaP, S0);
+    ConvergenceTable gathererStatic{std::make_unique<StatisticsMean>()};
+
+    engineStatic.doSimulation(gathererStatic, nScen);
+
+    std::cout << "Static engine results are: " << gathererStatic.resultsSoFar() << "\n\n";
+
+    // the same, with the Ziggurat gaussians over the vectorised xoshiro uniforms
+    ExoticBSEngine<Ziggurat<RandomXoshiro<1>, 1>> engineZiggurat(option, rP, dP, sigmaP, S0);
+    ConvergenceTable gathererZiggurat{std::make_unique<StatisticsMean>()};
+
+    engineZiggurat.doSimulation(gathererZiggurat, nScen);
+
+    std::cout << "Ziggurat over xoshiro results are: " << gathererZiggurat.resultsSoFar() << "\n";
+
+    // the draws themselves against the normal distribution, the tail beyond the Ziggurat's base layer included
+    {
+        Ziggurat<RandomXoshiro<1>, 1> ziggurat;
+        std::vector<double> draws(1000000);
+        draws = ziggurat.gaussians(std::move(draws));
+
+        double n = static_cast<double>(draws.size());
+        double mean = std::accumulate(draws.begin(), draws.end(), 0.0) / n;
+        double variance = std::inner_product(draws.begin(), draws.end(), draws.begin(), 0.0) / n - mean * mean;
+        auto inTail = [](double p_z) { return std::abs(p_z) > 3.5; };
+        double tail = static_cast<double>(std::count_if(draws.begin(), draws.end(), inTail)) / n;
+
+        std::cout << "with the draws' mean: " << mean << ", variance: " << variance << ", P(|z| > 3.5): " << tail
+                  << " vs " << std::erfc(3.5 / std::sqrt(2.0)) << "\n\n";
+    }
+
+    // the vectorised xoshiro against the outputs of the authors' scalar xoshiro256+, seeded by splitmix64 with 1 & each lane
+    // jumped from the previous one: the uniforms interleave the lanes, whichever the split of the calls
+    {
+        const std::vector<double> reference{
+            0x1.65da3ebba294p-7,  0x1.b11f321c9d8bbp-1, 0x1.26115469983adp-1, 0x1.a2bf6aa538f3bp-1,
+            0x1.9ee38603f4ce9p-1, 0x1.367a07827b533p-1, 0x1.7c7640d864a13p-1, 0x1.a60b100a5b11cp-3,
+            0x1.c59b818488695p-1, 0x1.9728793db4f81p-1, 0x1.b65d427d3fa3bp-1, 0x1.e5f0161251ff1p-1,
+            0x1.fa5669fc9a49bp-1, 0x1.66c02c12a020ap-2, 0x1.83e2ad0a1e913p-1, 0x1.be666427069eep-2};
+        // the same after a long jump
+        const std::vector<double> referenceLongJump{
+            0x1.b3137d5268839p-1, 0x1.ac01993fc5a69p-1, 0x1.d5e98c7817efbp-1, 0x1.a7659b3f62341p-1,
+            0x1.c07a4de87f6f4p-3, 0x1.def75c81a46bep-2, 0x1.bae4d9a208974p-3, 0x1.2996e985d897cp-3};
+
+        RandomXoshiro<1> xoshiro(1);
+        std::vector<double> first(5);
+        std::vector<double> second(reference.size() - first.size());
+        first = xoshiro.uniforms(std::move(first));
+        second = xoshiro.uniforms(std::move(second));
+        first.insert(first.end(), second.begin(), second.end());
+
+        RandomXoshiro<1> xoshiroLongJump(1);
+        xoshiroLongJump.longJump();
+        std::vector<double> jumped(referenceLongJump.size());
+        jumped = xoshiroLongJump.uniforms(std::move(jumped));
+
+        std::cout << "xoshiro as the reference: " << std::boolalpha << (first == reference)
+                  << ", after a long jump: " << (jumped == referenceLongJump) << "\n\n";
+    }
+
+    // a local volatility process on a flat surface is the Black-Scholes one: the prices agree within the Monte-Carlo error
+    LocalVolSurface flatSurface(0.0, 1.0, 1, std::log(S0) - 1.0, 2.0, 2, {sigma, sigma});
+    ExoticLocalVolEngine<decltype(generator)> engineLocalVol(option, rP, dP, flatSurface, S0, 0.25);
+    StatisticsMean gathererLocalVol;
+
+    engineLocalVol.doSimulation(gathererLocalVol, nScen);
+
+    std::cout << "Flat local vol results are: " << gathererLocalVol.resultsSoFar() << "\n\n";
+
+    // a seeded run recorded to a file & replayed through the engines, which reproduces it bit-for-bit, e.g. elsewhere
+    {
+        const std::string recordingPath = "ch7_gaussians.bin";
+        size_t nRecorded = std::min(nScen, size_t{100000});
+        long seed = 42;
+
+        std::remove(recordingPath.c_str());
+        RandomMapped<1> recording(recordingPath, nRecorded * nDates, MersenneTwister<1>{seed});
+
+        using StaticAsian = StaticAsianOptionArith<PayoffCall>;
+        ExoticBSEngine<MersenneTwister<1>> engineRun(option, rP, dP, sigmaP, S0, MersenneTwister<1>{seed});
+        ExoticBSEngine<RandomMapped<1>> engineReplay(option, rP, dP, sigmaP, S0, recording);
+        Engine<BSProcess, StaticAsian, MersenneTwister<1>> engineRunStatic(MersenneTwister<1>{seed}, {dates, T, payoff}, rP, dP,
+                                                                           sigmaP, S0);
+        Engine<BSProcess, StaticAsian, RandomMapped<1>> engineReplayStatic(recording, {dates, T, payoff}, rP, dP, sigmaP, S0);
+
+        StatisticsMean gathererRun;
+        StatisticsMean gathererReplay;
+        StatisticsMean gathererRunStatic;
+        StatisticsMean gathererReplayStatic;
+        engineRun.doSimulation(gathererRun, nRecorded);
+        engineReplay.doSimulation(gathererReplay, nRecorded);
+        engineRunStatic.doSimulation(gathererRunStatic, nRecorded);
+        engineReplayStatic.doSimulation(gathererReplayStatic, nRecorded);
+
+        std::remove(recordingPath.c_str());
+
+        std::cout << "Recorded run results are: " << gathererRun.resultsSoFar() << ", replayed: " << gathererReplay.resultsSoFar()
+                  << "\n";
+        std::cout << "replayed bit-for-bit: " << std::boolalpha
+                  << (gathererRun.resultsSoFar() == gathererReplay.resultsSoFar()
+                      && gathererRunStatic.resultsSoFar() == gathererReplayStatic.resultsSoFar())
+                  << "\n\n";
+    }
+
+    // the gaussians produced ahead on a separate thread are those of the wrapped generator, call for call, also across a skip
+    // & a reset. Park-Miller, since its skip is exact: one uniform per gaussian
+    {
+        using Generator = AntiThetic<RandomParkMiller<1>, 1>;
+        long seed = 42;
+        // even, so that the skips start on an anti-thetic pair
+        size_t nPaths = 1000;
+
+        Generator bare(seed);
+        RandomAsync<Generator, 1> ahead(Generator{seed});
+
+        std::vector<double> expected(nDates);
+        std::vector<double> drawn(nDates);
+        auto same = [&]() {
+            bool ret = true;
+            for (size_t i = 0; i < nPaths; ++i)
+            {
+                expected = bare.gaussians(std::move(expected));
+                drawn = ahead.gaussians(std::move(drawn));
+                ret = ret && drawn == expected;
+            }
+            return ret;
+        };
+
+        bool sameDrawn = same();
+        bare.skip(nPaths * nDates);
+        ahead.skip(nPaths * nDates);
+        bool sameSkipped = same();
+        bare.reset();
+        ahead.reset();
+        bool sameReset = same();
+
+        std::cout << "produced ahead bit-for-bit: " << std::boolalpha << sameDrawn << ", after a skip: " << sameSkipped
+                  << ", after a reset: " << sameReset << "\n\n";
+    }
+
+    // block mode: a batch of anti-thetic pairs is the fresh draws of the wrapped generator followed by their negation,
+    // regardless of a mirror pending from the previous call
+    {
+        long seed = 42;
+        size_t nPairs = 1000;
+
+        AntiThetic<RandomParkMiller<1>, 1> paired(seed);
+        RandomParkMiller<1> fresh(seed);
+
+        std::vector<double> path(nDates);
+        path = paired.gaussians(std::move(path));
+        path = fresh.gaussians(std::move(path));
+
+        std::vector<double> batch(2 * nPairs * nDates);
+        std::vector<double> expected(nPairs * nDates);
+        batch = paired.gaussianPairs(std::move(batch));
+        expected = fresh.gaussians(std::move(expected));
+
+        auto mirrors = batch.begin() + static_cast<std::ptrdiff_t>(expected.size());
+        auto mirrored = [](double p_z, double p_mirror) { return p_mirror == -p_z; };
+        bool samePairs = std::equal(expected.begin(), expected.end(), batch.begin())
+                         && std::equal(expected.begin(), expected.end(), mirrors, mirrored);
+
+        std::cout << "anti-thetic pairs in block mode: " << std::boolalpha << samePairs << "\n\n";
+    }
+
+#ifdef TESTING
+    // the steady state allocates nothing per path: the cash-flows are written into the engines' buffers
+    {
+        StatisticsMean gathererAlloc;
+        size_t before = g_allocations;
+        engine.doSimulation(gathererAlloc, nScen);
+        engineStatic.doSimulation(gathererAlloc, nScen);
+        size_t allocations = g_allocations - before;
+
+        // the spots of each simulation
+        if (allocations > 2)
+        {
+            std::cout << "FAILED: " << allocations << " allocations for " << 2 * nScen << " paths\n";
+            return 1;
+        }
+    }
+#endif
+
+    // the geometric Asian on the same paths as a control variate - it has a closed-form price
+    AsianOptionGeom control(dates, T, payoff);
+    StatisticsControlVariate gathererCV{control.blackScholesPrice(S0, rP, dP, sigmaP)};
+
+    engine.doSimulation(gathererCV, control, nScen);
+
+    std::cout << "Control variate results are: " << gathererCV.resultsSoFar() << "\n";
+    std::cout << "with the variance reduced by a factor of: " << gathererCV.varianceReductionFactor() << "\n\n";
+
+    // a strip of strikes priced on the same paths, the geometric Asian (last lane) controlling all of them
+    std::vector<std::unique_ptr<PathDependent>> strip;
+    for (double strike : {0.8 * K, K, 1.2 * K})
+    {
+        strip.push_back(std::make_unique<AsianOptionArith>(dates, T, PayoffCall{strike}));
+    }
+    strip.push_back(control.clone());
+
+    ExoticBSEngine<decltype(generator)> engineStrip(PathDependentMultiple{std::move(strip)}, rP, dP, sigmaP, S0);
+    StatisticsControlVariates gathererStrip{4, {{3, control.blackScholesPrice(S0, rP, dP, sigmaP)}}};
+
+    engineStrip.doSimulation(gathererStrip, nScen);
+
+    std::cout << "Strip results are: " << gathererStrip.resultsSoFar() << "\n";
+    std::cout << "with the variance reduced by factors of: " << gathererStrip.varianceReductionFactors() << "\n\n";
+
+    // a continuously monitored down-and-out call on the averaging dates only, bridged in between
+    BarrierOption barrier(dates, T, payoff, 0.8 * S0, BarrierType::DownAndOut);
+    ExoticBSEngine<decltype(generator)> engineBarrier(barrier, rP, dP, sigmaP, S0);
+    StatisticsMean gathererBarrier;
+
+    engineBarrier.doSimulation(gathererBarrier, nScen);
+
+    std::cout << "Down-and-out call results are: " << gathererBarrier.resultsSoFar() << "\n";
+
+    // the same, evolving blocks of paths date by date into running states - the paths are never held whole
+    StatisticsMean gathererStreaming;
+    engineBarrier.doSimulationStreaming(gathererStreaming, nScen);
+
+    std::cout << "streamed: " << gathererStreaming.resultsSoFar() << "\n\n";
+
+    // a fixed-strike lookback & a cliquet of returns floored @ 0 and capped @ 5% per period, evaluated on running states
+    LookbackOption lookback(dates, T, payoff, Extremum::Maximum, LookbackStrike::Fixed);
+    ExoticBSEngine<decltype(generator)> engineLookback(lookback, rP, dP, sigmaP, S0);
+    StatisticsMean gathererLookback;
+    engineLookback.doSimulation(gathererLookback, nScen);
+
+    CliquetOption cliquet(dates, T, 0.0, 0.05, 0.0, 1.0, S0);
+    ExoticBSEngine<decltype(generator)> engineCliquet(cliquet, rP, dP, sigmaP, S0);
+    StatisticsMean gathererCliquet;
+    engineCliquet.doSimulation(gathererCliquet, nScen);
+
+    std::cout << "Lookback call results are: " << gathererLookback.resultsSoFar() << "\n";
+    std::cout << "Cliquet results are: " << gathererCliquet.resultsSoFar() << "\n\n";
+
+    // the sensitivities to every bucket of the term structures, in one adjoint run
+    auto risk = engine.doSimulationAAD(nScen);
+
+    std::cout << "AAD price: " << risk.price << ", delta: " << risk.delta << "\n";
+    std::cout << "bucketed over: " << risk.bucketTimes << "\n";
+    std::cout << "rho: " << risk.rates << "\n";
+    std::cout << "dividend rho: " << risk.dividends << "\n";
+    std::cout << "vega: " << risk.vols << "\n\n";
+
+    // the pathwise & the likelihood ratio Greeks of a call & a double digital, against bumping & revaluing on the same draws.
+    // The pathwise Greeks of the double digital are 0 by design - its payoff is flat but for the jumps, which they miss - the
+    // likelihood ratio is the method for it. The third call also fixes @ time 0, where the spot is not random: the likelihood ratio
+    // then weights by the density of the first random date & differentiates the fixing @ 0 pathwise
+    {
+        std::vector<double> datesFrom0{0.0};
+        datesFrom0.insert(datesFrom0.end(), dates.begin(), dates.end());
+
+        std::vector<std::unique_ptr<PathDependent>> products;
+        products.push_back(std::make_unique<AsianOptionArith>(dates, T, payoff));
+        products.push_back(std::make_unique<AsianOptionArith>(dates, T, PayoffDoubleDigital{0.8 * S0, 1.2 * S0}));
+        products.push_back(std::make_unique<AsianOptionArith>(datesFrom0, T, payoff));
+        const std::vector<std::string> names{"Call", "Double digital", "Call fixing @ 0"};
+        PathDependentMultiple trio{std::move(products)};
+        long seed = 7;
+
+        // the lanes are (price, delta, vega) per product
+        auto greeks = [&](GreeksMethod p_method) {
+            StatisticsMultipleMean gathererGreeks{9};
+            ExoticBSEngine<MersenneTwister<1>> engineGreeks(trio, rP, dP, sigmaP, S0, MersenneTwister<1>{seed});
+            engineGreeks.doSimulationGreeks(gathererGreeks, nScen, p_method);
+            return gathererGreeks.resultsSoFar();
+        };
+        auto price = [&](double p_spot, double p_vol) {
+            StatisticsMultipleMean gathererBumped{3};
+            ExoticBSEngine<MersenneTwister<1>> engineBumped(trio, rP, dP, ParametersConstant{p_vol}, p_spot, MersenneTwister<1>{seed});
+            engineBumped.doSimulation(gathererBumped, nScen);
+            return gathererBumped.resultsSoFar();
+        };
+
+        auto pathwise = greeks(GreeksMethod::Pathwise);
+        auto likelihoodRatio = greeks(GreeksMethod::LikelihoodRatio);
+
+        double spotBump = 0.01 * S0;
+        double volBump = 0.01;
+        auto spotUp = price(S0 + spotBump, sigma);
+        auto spotDown = price(S0 - spotBump, sigma);
+        auto volUp = price(S0, sigma + volBump);
+        auto volDown = price(S0, sigma - volBump);
+
+        for (size_t j = 0; j < names.size(); ++j)
+        {
+            std::cout << names[j] << " price: " << pathwise[3 * j][0] << "\n";
+            std::cout << "delta - pathwise: " << pathwise[3 * j + 1][0] << ", likelihood ratio: " << likelihoodRatio[3 * j + 1][0]
+                      << ", bumped: " << (spotUp[j][0] - spotDown[j][0]) / (2.0 * spotBump) << "\n";
+            std::cout << "vega - pathwise: " << pathwise[3 * j + 2][0] << ", likelihood ratio: " << likelihoodRatio[3 * j + 2][0]
+                      << ", bumped: " << (volUp[j][0] - volDown[j][0]) / (2.0 * volBump) << "\n";
+        }
+        std::cout << "\n";
+    }
+
+    // bump & revalue on common random numbers
+    ScenarioRunner<decltype(generator)> runner(option, rP, dP, sigmaP, S0, nScen, ScenarioDraws::Cached);
+    double bump = 0.01;
+    auto scenarios = runner.run({{}, {bump, 0.0, 0.0, 0.0}, {-bump, 0.0, 0.0, 0.0}}, StatisticsMean{});
+
+    double up = scenarios[1]->resultsSoFar()[0][0];
+    double down = scenarios[2]->resultsSoFar()[0][0];
+    std::cout << "Scenario base price: " << scenarios[0]->resultsSoFar()[0][0] << "\n";
+    std::cout << "bumped delta: " << (up - down) / (2.0 * bump * S0) << "\n\n";
+
     return 0;
 }
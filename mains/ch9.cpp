@@ -5,13 +5,19 @@
  * Ch. 9: Solvers, templates, and implied volatilities.
  */
 
+#include <chrono>
 #include <cstddef>
 #include <iostream>
+#include <utility>
+#include <vector>
 #ifdef NDEBUG
 #include <sstream>
 #endif
 
+#include "../src/bsbatch.h"
+#include "../src/calibration.h"
 #include "../src/derivatives.h"
+#include "../src/impliedvol.h"
 #include "../src/solver.h"
 
 using namespace der;
@@ -60,5 +66,87 @@ int main()
         std::cout << "Exception: " << e.what() << "\n";
     }
 
+    // the counting solvers, to the same tolerance as the bisection's
+    Solver solver{1e-5};
+    BSCall call(r, d, T, {}, S0, K);
+
+    double impVolBrent = solver.brent(88.2363, call, 0.01, 2.0);
+    std::cout << "Implied volatility by Brent's method is: " << impVolBrent << ", in " << solver.evaluations() << " evaluations\n";
+
+    double impVolNewton =
+        solver.newton(88.2363, [&call](double p_sigma) { return std::make_pair(call(p_sigma), call.vega(p_sigma)); }, 0.4, 0.01, 2.0);
+    std::cout << "Implied volatility by the safeguarded Newton's method is: " << impVolNewton << ", in " << solver.evaluations()
+              << " evaluations\n";
+
+    // a chain of 8 expiries by a strip of strikes, priced in one batch
+    size_t nOptions = 1 << 20;
+    std::vector<OptionType> types(nOptions);
+    std::vector<double> spots(nOptions, S0), strikes(nOptions), expiries(nOptions), rates(nOptions, r), dividends(nOptions, d),
+        vols(nOptions, sigma), prices(nOptions), vegas(nOptions);
+    for (size_t i = 0; i < nOptions; ++i)
+    {
+        types[i] = i % 2 == 0 ? OptionType::Call : OptionType::Put;
+        strikes[i] = 0.5 * S0 + S0 * static_cast<double>(i % (nOptions / 8)) / static_cast<double>(nOptions / 8);
+        expiries[i] = T * static_cast<double>(1 + i / (nOptions / 8)) / 8.;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    blackScholesBatch({types, spots, strikes, expiries, rates, dividends, vols}, {prices, {}, vegas});
+    auto end = std::chrono::steady_clock::now();
+
+    size_t mid = nOptions - nOptions / 16;
+    std::cout << "Batch of " << nOptions << " options priced in " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms; @ K = " << strikes[mid] << ": " << prices[mid]
+              << " vs. " << BSCall::BSCallFormula(r, d, T, sigma, S0, strikes[mid]) << "\n";
+
+    // & back
+    std::vector<double> impliedVols(nOptions);
+    std::vector<ImpliedVolStatus> statuses(nOptions);
+
+    start = std::chrono::steady_clock::now();
+    size_t nConverged = impliedVolBatch({types, prices, spots, strikes, expiries, rates, dividends}, {impliedVols, statuses});
+    end = std::chrono::steady_clock::now();
+
+    std::cout << "Implied volatilities of the batch solved in " << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms; converged: " << nConverged << ", @ K = " << strikes[mid] << ": " << impliedVols[mid] << "\n";
+
+    // a term structure of volatility recovered from the quotes it prices
+    ParametersPiecewiseConstant trueVol({0.25, 0.5, 1.0, 2.0}, {0.30, 0.22, 0.18, 0.25});
+    std::vector<OptionQuote> quotes;
+    for (double expiry : trueVol.times())
+    {
+        for (double strike = 0.7 * S0; strike <= 1.3 * S0; strike += 0.05 * S0)
+        {
+            OptionType type = strike < S0 ? OptionType::Put : OptionType::Call;
+            double vol = Parameters(trueVol).RMS(0.0, expiry);
+            double price;
+            blackScholesBatch({Span<const OptionType>(&type, 1), {&S0, 1}, {&strike, 1}, {&expiry, 1}, {&r, 1}, {&d, 1}, {&vol, 1}},
+                              {{&price, 1}, {}, {}});
+            quotes.push_back({type, strike, expiry, price});
+        }
+    }
+
+    VolCalibration calibration(quotes, S0, ParametersConstant(r), ParametersConstant(d));
+
+    ParametersPiecewiseConstant bootstrapped = calibration.bootstrap();
+    std::cout << "Bootstrapped volatilities:";
+    for (size_t i = 0; i < bootstrapped.values().size(); ++i)
+    {
+        std::cout << " " << bootstrapped.values()[i] << " (" << calibration.iterations()[i].seconds * 1e6 << " us)";
+    }
+    std::cout << "\n";
+
+    ParametersPiecewiseConstant fitted = calibration.fit(ParametersConstant(sigma));
+    std::cout << "Fitted volatilities:";
+    for (double vol : fitted.values())
+    {
+        std::cout << " " << vol;
+    }
+    std::cout << "\n";
+    for (const CalibrationIteration & iteration : calibration.iterations())
+    {
+        std::cout << "    error " << iteration.error << ", damping " << iteration.damping << ", " << iteration.seconds * 1e6 << " us\n";
+    }
+
     return 0;
 }
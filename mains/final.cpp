@@ -5,10 +5,12 @@
  * Final project: Multithreaded trinomial tree pricing.
  */
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stddef.h>
 
+#include "../src/marketsnapshot.h"
 #include "../src/parameters.h"
 #include "../src/payoff.h"
 #include "../src/tree.h"
@@ -16,7 +18,8 @@
 
 using namespace der;
 
-int main()
+//! \brief Usage: final [snapshot], the rate & dividend curves read from the market snapshot, c.f. \a MarketSnapshot, if given.
+int main(int argc, char * argv[])
 {
     double S0, K, T, sigma, r, d;
     size_t nSteps;
@@ -49,6 +52,23 @@ int main()
     Parameters rP{ParametersConstant(r)};
     Parameters dP{ParametersConstant(d)};
 
+    // the curves of a snapshot are mapped, not parsed: nothing to wait for on startup
+    if (argc > 1)
+    {
+        if (!std::ifstream{argv[1]})
+        {
+            // a flat snapshot of the above, for a start
+            MarketSnapshot::Writer writer;
+            writer.add("r", ParametersPiecewiseConstant({T}, {r}));
+            writer.add("d", ParametersPiecewiseConstant({T}, {d}));
+            writer.write(argv[1]);
+        }
+
+        MarketSnapshot snapshot(argv[1]);
+        rP = snapshot.curve("r");
+        dP = snapshot.curve("d");
+    }
+
     // the pricing tree
     trinomialTree tree(nSteps, 0.5, S0, rP, dP, sigma, T);
 
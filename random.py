@@ -13,14 +13,14 @@ import matplotlib.pyplot as plt
 
 import csv
 
-# the data is generated by enabling the macro DUMPINTERMEDIATE in CMake
+# the samples are dumped by enabling the SampleSink channels, e.g. by ch6 in a Debug build
 
 # intermediate dists
-a = np.array(list(map(float, list(csv.reader(open("uniforms")))[0])))
+a = np.load("uniforms.npy", mmap_mode='r')
 plt.hist(a, bins=10, density=True)
 
 plt.figure()
-b = np.array(list(map(float, list(csv.reader(open("gaussians")))[0])))
+b = np.array(np.load("gaussians.npy", mmap_mode='r'))
 b[b == -np.inf] = -np.finfo(float).max
 b[b == np.inf] = np.finfo(float).max
 bhist = b[b > -1000]
@@ -0,0 +1,329 @@
+/** \file aad.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Adjoint algorithmic differentiation (reverse-mode AD) on a tape.
+ */
+
+#ifndef AAD_H
+#define AAD_H
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace der
+{
+
+//! \brief Adjoint algorithmic differentiation.
+//! The operations live in a namespace of their own so that they are found by ADL on \a Number only, and never pick up plain
+//! doubles through the implicit conversion.
+namespace aad
+{
+
+//! \brief A node on the tape: the result of an elementary operation with up to two arguments.
+//! Holds the local derivatives w.r.t. the arguments and the adjoint being accumulated during the backward sweep.
+struct Node
+{
+    double adjoint;
+    size_t nArgs;
+    double partials[2];
+    Node * args[2];
+};
+
+//! \brief The tape recording the elementary operations of a calculation, to be swept backwards for the adjoints.
+//! The nodes live in an arena of fixed-size blocks that are never freed or moved while the tape lives, so recording
+//! does no heap allocation once the tape has grown to its working size.
+//! There is one tape per thread, c.f. \a instance.
+class Tape
+{
+public:
+    //! \brief A position on the tape.
+    using Mark = size_t;
+
+    //! \brief The tape of the calling thread.
+    static Tape & instance();
+
+    //! \brief Records a new node with \p p_nArgs arguments and a zero adjoint.
+    //! \return The node, whose arguments and partials are for the caller to fill in.
+    Node * record(size_t p_nArgs);
+
+    //! \brief The current end of the tape, e.g. to checkpoint before a calculation that is to be repeated.
+    Mark mark() const;
+    //! \brief Discards everything recorded after \p p_mark, keeping the memory.
+    void rewind(Mark p_mark);
+    //! \brief Discards everything.
+    void clear();
+
+    //! \brief Propagates the adjoints backwards, from the node just before \p p_from down to \p p_to.
+    //! The adjoints of the arguments recorded before \p p_to keep accumulating - this is what makes checkpointing work.
+    //! \param p_from
+    //! \param p_to
+    void propagate(Mark p_from, Mark p_to);
+
+private:
+    Tape() = default;
+
+    Node & node(Mark p_position);
+
+    static constexpr size_t s_blockSize = 1 << 14;
+
+    std::vector<std::unique_ptr<Node[]>> m_blocks;
+    //! \brief The position of the next node.
+    Mark m_end{0};
+};
+
+//! \brief Rewinds the calling thread's tape to where it was on construction when leaving the scope, exceptions included -
+//! the nodes recorded in-between point into the caller's stack and must not outlive it.
+class TapeScope
+{
+public:
+    TapeScope();
+    ~TapeScope();
+
+    TapeScope(const TapeScope &) = delete;
+    TapeScope & operator=(const TapeScope &) = delete;
+
+    Tape & tape() const;
+    //! \brief The end of the tape on construction.
+    Tape::Mark start() const;
+
+private:
+    Tape & m_tape;
+    Tape::Mark m_start;
+};
+
+//! \brief A number recording its operations on the calling thread's \a Tape.
+//! A default-constructed number is not on the tape - it must be assigned to before use.
+class Number
+{
+public:
+    Number() = default;
+    //! \brief An independent variable or a constant: a leaf on the tape.
+    // no explicit since we want implicit conversion
+    Number(double p_value);
+
+    double value() const;
+    //! \brief The adjoint accumulated on the node, i.e. the derivative of the propagated result w.r.t. this number.
+    double & adjoint() const;
+
+    //! \brief Records a unary operation with result \p p_value and derivative \p p_partial w.r.t. \p p_arg.
+    static Number unary(const Number & p_arg, double p_value, double p_partial);
+    //! \brief Records a binary operation with result \p p_value and derivatives \p p_partial1 & \p p_partial2.
+    static Number binary(const Number & p_arg1, const Number & p_arg2, double p_value, double p_partial1,
+                            double p_partial2);
+
+    Number & operator+=(const Number & p_other);
+    Number & operator-=(const Number & p_other);
+    Number & operator*=(const Number & p_other);
+    Number & operator/=(const Number & p_other);
+
+private:
+    double m_value{0.0};
+    Node * m_node{nullptr};
+};
+
+//! \name Operations on Numbers.
+//!@{
+Number operator-(const Number & p_x);
+
+Number operator+(const Number & p_x, const Number & p_y);
+Number operator+(const Number & p_x, double p_y);
+Number operator+(double p_x, const Number & p_y);
+
+Number operator-(const Number & p_x, const Number & p_y);
+Number operator-(const Number & p_x, double p_y);
+Number operator-(double p_x, const Number & p_y);
+
+Number operator*(const Number & p_x, const Number & p_y);
+Number operator*(const Number & p_x, double p_y);
+Number operator*(double p_x, const Number & p_y);
+
+Number operator/(const Number & p_x, const Number & p_y);
+Number operator/(const Number & p_x, double p_y);
+Number operator/(double p_x, const Number & p_y);
+
+Number exp(const Number & p_x);
+Number log(const Number & p_x);
+Number sqrt(const Number & p_x);
+Number pow(const Number & p_x, double p_y);
+
+//! \brief The value of a plain double or of a \a Number - for the calculations templated on the number type.
+double value(double p_x);
+double value(const Number & p_x);
+//!@}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Tape
+
+inline Tape & Tape::instance()
+{
+    thread_local Tape tape;
+    return tape;
+}
+
+inline Node & Tape::node(Mark p_position) { return m_blocks[p_position / s_blockSize][p_position % s_blockSize]; }
+
+inline Node * Tape::record(size_t p_nArgs)
+{
+    if (m_end == m_blocks.size() * s_blockSize)
+    {
+        m_blocks.push_back(std::make_unique<Node[]>(s_blockSize));
+    }
+
+    Node & ret = node(m_end++);
+    ret.adjoint = 0.0;
+    ret.nArgs = p_nArgs;
+    return &ret;
+}
+
+inline Tape::Mark Tape::mark() const { return m_end; }
+
+inline void Tape::rewind(Mark p_mark) { m_end = p_mark; }
+
+inline void Tape::clear() { m_end = 0; }
+
+inline void Tape::propagate(Mark p_from, Mark p_to)
+{
+    for (Mark i = p_from; i-- > p_to;)
+    {
+        const Node & current = node(i);
+        if (current.adjoint == 0.0)
+        {
+            continue;
+        }
+
+        for (size_t j = 0; j < current.nArgs; ++j)
+        {
+            current.args[j]->adjoint += current.partials[j] * current.adjoint;
+        }
+    }
+}
+
+// TapeScope
+
+inline TapeScope::TapeScope() : m_tape(Tape::instance()), m_start(m_tape.mark()) {}
+
+inline TapeScope::~TapeScope() { m_tape.rewind(m_start); }
+
+inline Tape & TapeScope::tape() const { return m_tape; }
+
+inline Tape::Mark TapeScope::start() const { return m_start; }
+
+// Number
+
+inline Number::Number(double p_value) : m_value(p_value), m_node(Tape::instance().record(0)) {}
+
+inline double Number::value() const { return m_value; }
+
+inline double & Number::adjoint() const { return m_node->adjoint; }
+
+inline Number Number::unary(const Number & p_arg, double p_value, double p_partial)
+{
+    Number ret;
+    ret.m_value = p_value;
+    ret.m_node = Tape::instance().record(1);
+    ret.m_node->partials[0] = p_partial;
+    ret.m_node->args[0] = p_arg.m_node;
+    return ret;
+}
+
+inline Number Number::binary(const Number & p_arg1, const Number & p_arg2, double p_value, double p_partial1,
+                                   double p_partial2)
+{
+    Number ret;
+    ret.m_value = p_value;
+    ret.m_node = Tape::instance().record(2);
+    ret.m_node->partials[0] = p_partial1;
+    ret.m_node->partials[1] = p_partial2;
+    ret.m_node->args[0] = p_arg1.m_node;
+    ret.m_node->args[1] = p_arg2.m_node;
+    return ret;
+}
+
+inline Number & Number::operator+=(const Number & p_other) { return *this = *this + p_other; }
+
+inline Number & Number::operator-=(const Number & p_other) { return *this = *this - p_other; }
+
+inline Number & Number::operator*=(const Number & p_other) { return *this = *this * p_other; }
+
+inline Number & Number::operator/=(const Number & p_other) { return *this = *this / p_other; }
+
+// operations
+
+inline Number operator-(const Number & p_x) { return Number::unary(p_x, -p_x.value(), -1.0); }
+
+inline Number operator+(const Number & p_x, const Number & p_y)
+{
+    return Number::binary(p_x, p_y, p_x.value() + p_y.value(), 1.0, 1.0);
+}
+
+inline Number operator+(const Number & p_x, double p_y) { return Number::unary(p_x, p_x.value() + p_y, 1.0); }
+
+inline Number operator+(double p_x, const Number & p_y) { return p_y + p_x; }
+
+inline Number operator-(const Number & p_x, const Number & p_y)
+{
+    return Number::binary(p_x, p_y, p_x.value() - p_y.value(), 1.0, -1.0);
+}
+
+inline Number operator-(const Number & p_x, double p_y) { return Number::unary(p_x, p_x.value() - p_y, 1.0); }
+
+inline Number operator-(double p_x, const Number & p_y) { return Number::unary(p_y, p_x - p_y.value(), -1.0); }
+
+inline Number operator*(const Number & p_x, const Number & p_y)
+{
+    return Number::binary(p_x, p_y, p_x.value() * p_y.value(), p_y.value(), p_x.value());
+}
+
+inline Number operator*(const Number & p_x, double p_y) { return Number::unary(p_x, p_x.value() * p_y, p_y); }
+
+inline Number operator*(double p_x, const Number & p_y) { return p_y * p_x; }
+
+inline Number operator/(const Number & p_x, const Number & p_y)
+{
+    double inv = 1.0 / p_y.value();
+    return Number::binary(p_x, p_y, p_x.value() * inv, inv, -p_x.value() * inv * inv);
+}
+
+inline Number operator/(const Number & p_x, double p_y) { return p_x * (1.0 / p_y); }
+
+inline Number operator/(double p_x, const Number & p_y)
+{
+    double inv = 1.0 / p_y.value();
+    return Number::unary(p_y, p_x * inv, -p_x * inv * inv);
+}
+
+inline Number exp(const Number & p_x)
+{
+    double value = std::exp(p_x.value());
+    return Number::unary(p_x, value, value);
+}
+
+inline Number log(const Number & p_x) { return Number::unary(p_x, std::log(p_x.value()), 1.0 / p_x.value()); }
+
+inline Number sqrt(const Number & p_x)
+{
+    double value = std::sqrt(p_x.value());
+    return Number::unary(p_x, value, 0.5 / value);
+}
+
+inline Number pow(const Number & p_x, double p_y)
+{
+    double value = std::pow(p_x.value(), p_y);
+    return Number::unary(p_x, value, p_y * value / p_x.value());
+}
+
+inline double value(double p_x) { return p_x; }
+
+inline double value(const Number & p_x) { return p_x.value(); }
+
+} // namespace aad
+
+} // namespace der
+
+#endif // AAD_H
@@ -0,0 +1,130 @@
+/** \file bsbatch.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "bsbatch.h"
+#include "simdmath.h"
+
+namespace der
+{
+
+namespace
+{
+
+//! \brief The fewest options worth a thread of their own.
+constexpr size_t s_minChunk = size_t{1} << 14;
+
+//! \brief Prices \p p_n options. The outputs are compile-time switches so that the loop has no branches.
+//! The pointers are parameters as restrict-qualified locals are ignored by the compilers' alias analyses.
+template <bool Prices, bool Deltas, bool Vegas>
+void kernel(size_t p_n, const OptionType * __restrict types, const double * __restrict spots, const double * __restrict strikes,
+            const double * __restrict expiries, const double * __restrict rates, const double * __restrict dividends,
+            const double * __restrict vols, double * __restrict prices, double * __restrict deltas, double * __restrict vegas)
+{
+#pragma omp simd
+    for (size_t i = 0; i < p_n; ++i)
+    {
+        double S0 = spots[i];
+        double K = strikes[i];
+        double T = expiries[i];
+
+        double sqrtT = std::sqrt(std::max(T, 0.0));
+        // floored so that a zero expiry or vol sends d1 to +-infinity rather than to a NaN
+        double stdDev = std::max(vols[i] * sqrtT, std::numeric_limits<double>::min());
+        double dfR = simd::exp(-rates[i] * T);
+        double dfD = simd::exp(-dividends[i] * T);
+
+        double d1 = (simd::log(S0 / K) + (rates[i] - dividends[i]) * T) / stdDev + 0.5 * stdDev;
+        double d2 = d1 - stdDev;
+
+        // calls & puts alike: omega * (S0 e^{-dT} N(omega d1) - K e^{-rT} N(omega d2))
+        double omega = types[i] == OptionType::Put ? -1.0 : 1.0;
+        double Nd1 = simd::cumulativeGaussian(omega * d1);
+
+        if constexpr (Prices)
+        {
+            prices[i] = omega * (dfD * S0 * Nd1 - dfR * K * simd::cumulativeGaussian(omega * d2));
+        }
+        if constexpr (Deltas)
+        {
+            deltas[i] = omega * dfD * Nd1;
+        }
+        if constexpr (Vegas)
+        {
+            vegas[i] = dfD * S0 * sqrtT * simd::gaussianDensity(d1);
+        }
+    }
+}
+
+//! \brief Prices the options [\p p_first, \p p_last).
+template <bool Prices, bool Deltas, bool Vegas>
+void kernelRange(const BSBatchInputs & p_inputs, const BSBatchOutputs & p_outputs, size_t p_first, size_t p_last)
+{
+    kernel<Prices, Deltas, Vegas>(p_last - p_first, p_inputs.types.data() + p_first, p_inputs.spots.data() + p_first,
+                                  p_inputs.strikes.data() + p_first, p_inputs.expiries.data() + p_first,
+                                  p_inputs.rates.data() + p_first, p_inputs.dividends.data() + p_first, p_inputs.vols.data() + p_first,
+                                  p_outputs.prices.data() + (Prices ? p_first : 0), p_outputs.deltas.data() + (Deltas ? p_first : 0),
+                                  p_outputs.vegas.data() + (Vegas ? p_first : 0));
+}
+
+using Kernel = void (*)(const BSBatchInputs &, const BSBatchOutputs &, size_t, size_t);
+
+//! \brief The instantiation for the requested outputs.
+Kernel selectKernel(const BSBatchOutputs & p_outputs)
+{
+    static constexpr Kernel kernels[8] = {
+        kernelRange<false, false, false>, kernelRange<true, false, false>, kernelRange<false, true, false>,
+        kernelRange<true, true, false>,   kernelRange<false, false, true>, kernelRange<true, false, true>,
+        kernelRange<false, true, true>,   kernelRange<true, true, true>};
+
+    size_t index = (p_outputs.prices.empty() ? 0 : 1) + (p_outputs.deltas.empty() ? 0 : 2) + (p_outputs.vegas.empty() ? 0 : 4);
+    return kernels[index];
+}
+
+} // namespace
+
+void blackScholesBatch(const BSBatchInputs & p_inputs, const BSBatchOutputs & p_outputs, size_t p_nThreads)
+{
+    size_t n = p_inputs.types.size();
+
+    if (p_inputs.spots.size() != n || p_inputs.strikes.size() != n || p_inputs.expiries.size() != n || p_inputs.rates.size() != n
+        || p_inputs.dividends.size() != n || p_inputs.vols.size() != n)
+    {
+        throw std::invalid_argument("blackScholesBatch: the input arrays differ in size.");
+    }
+    for (size_t size : {p_outputs.prices.size(), p_outputs.deltas.size(), p_outputs.vegas.size()})
+    {
+        if (size != 0 && size != n)
+        {
+            throw std::invalid_argument("blackScholesBatch: the output arrays are to be empty or of the inputs' size.");
+        }
+    }
+
+    Kernel kernel = selectKernel(p_outputs);
+
+    size_t nThreads = std::max(p_nThreads, size_t{1});
+    size_t chunk = std::max((n + nThreads - 1) / nThreads, s_minChunk);
+
+    // the calling thread takes the first chunk
+    std::vector<std::thread> threads;
+    for (size_t first = chunk; first < n; first += chunk)
+    {
+        threads.emplace_back(kernel, std::cref(p_inputs), std::cref(p_outputs), first, std::min(first + chunk, n));
+    }
+    kernel(p_inputs, p_outputs, 0, std::min(chunk, n));
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // namespace der
@@ -0,0 +1,64 @@
+/** \file bsbatch.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * The Black-Scholes formulas over arrays of options.
+ */
+
+#ifndef BSBATCH_H
+#define BSBATCH_H
+
+#include <cstddef>
+#include <thread>
+
+#include "span.h"
+
+namespace der
+{
+
+//! \brief The type of a European option.
+enum class OptionType
+{
+    Call,
+    Put
+};
+
+//! \brief The options to price, as a structure of arrays: the i-th option is the i-th element of each array.
+//! All the arrays are to be of the same size. The rates are continuously compounded, the expiries are in years.
+struct BSBatchInputs
+{
+    Span<const OptionType> types;
+    Span<const double> spots;
+    Span<const double> strikes;
+    Span<const double> expiries;
+    Span<const double> rates;
+    Span<const double> dividends;
+    Span<const double> vols;
+};
+
+//! \brief Where the results are written, caller-owned. An empty span skips that output, otherwise it is of the inputs' size.
+struct BSBatchOutputs
+{
+    Span<double> prices;
+    //! \brief \f$\frac{\partial V}{\partial S_0}\f$
+    Span<double> deltas;
+    //! \brief \f$\frac{\partial V}{\partial \sigma}\f$
+    Span<double> vegas;
+};
+
+//! \brief Prices arrays of European options by the Black-Scholes formulas, c.f. \a BSCall::BSCallFormula.
+//! The kernel is branch-free & uses the functions of simdmath.h, so that the compiler vectorizes it - for the instruction set the
+//! translation unit is built for, e.g. with -march=native, c.f. its flags in CMakeLists.txt.
+//! Large arrays are split in contiguous chunks across threads.
+//! Nothing is allocated besides the threads, there is no I/O.
+//! Degenerate inputs, i.e. a zero expiry or volatility, price to their zero-volatility limit rather than to a NaN.
+//! Throws std::invalid_argument if the sizes do not match.
+//! \param p_inputs
+//! \param p_outputs
+//! \param p_nThreads - The maximal number of threads to use; fewer are used for small arrays.
+void blackScholesBatch(const BSBatchInputs & p_inputs, const BSBatchOutputs & p_outputs,
+                       size_t p_nThreads = std::thread::hardware_concurrency());
+
+} // namespace der
+
+#endif // BSBATCH_H
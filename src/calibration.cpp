@@ -0,0 +1,352 @@
+/** \file calibration.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "calibration.h"
+#include "solver.h"
+
+namespace der
+{
+
+namespace
+{
+
+//! \brief The bracket of the volatility of a piece.
+constexpr double s_minVol = 1e-3;
+constexpr double s_maxVol = 5.0;
+
+//! \brief The damping of the first Levenberg-Marquardt step, relative to the diagonal of the normal equations, & its bounds.
+constexpr double s_initialDamping = 1e-3;
+constexpr double s_maxDamping = 1e10;
+
+//! \brief Solves \p p_A x = \p p_b in place, \p p_A an n x n row-major matrix, by Gaussian elimination with partial pivoting.
+//! \return x, in \p p_b.
+void solveLinear(std::vector<double> & p_A, std::vector<double> & p_b)
+{
+    size_t n = p_b.size();
+
+    for (size_t col = 0; col < n; ++col)
+    {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < n; ++row)
+        {
+            if (std::abs(p_A[row * n + col]) > std::abs(p_A[pivot * n + col]))
+            {
+                pivot = row;
+            }
+        }
+        if (p_A[pivot * n + col] == 0.0)
+        {
+            throw std::runtime_error("VolCalibration: the normal equations are singular.");
+        }
+        if (pivot != col)
+        {
+            std::swap_ranges(p_A.begin() + col * n, p_A.begin() + (col + 1) * n, p_A.begin() + pivot * n);
+            std::swap(p_b[col], p_b[pivot]);
+        }
+
+        for (size_t row = col + 1; row < n; ++row)
+        {
+            double factor = p_A[row * n + col] / p_A[col * n + col];
+            for (size_t k = col; k < n; ++k)
+            {
+                p_A[row * n + k] -= factor * p_A[col * n + k];
+            }
+            p_b[row] -= factor * p_b[col];
+        }
+    }
+
+    for (size_t row = n; row-- > 0;)
+    {
+        for (size_t k = row + 1; k < n; ++k)
+        {
+            p_b[row] -= p_A[row * n + k] * p_b[k];
+        }
+        p_b[row] /= p_A[row * n + row];
+    }
+}
+
+double secondsSince(std::chrono::steady_clock::time_point p_start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - p_start).count();
+}
+
+} // namespace
+
+VolCalibration::VolCalibration(std::vector<OptionQuote> p_quotes, double p_S0, const Parameters & p_r, const Parameters & p_d,
+                               size_t p_nThreads)
+    : m_nThreads(p_nThreads)
+{
+    if (p_quotes.empty())
+    {
+        throw std::invalid_argument("VolCalibration: no quotes to calibrate to.");
+    }
+    std::stable_sort(p_quotes.begin(), p_quotes.end(),
+                     [](const OptionQuote & p_lhs, const OptionQuote & p_rhs) { return p_lhs.expiry < p_rhs.expiry; });
+    if (p_quotes.front().expiry <= 0.0)
+    {
+        throw std::invalid_argument("VolCalibration: the expiries are to be positive.");
+    }
+
+    size_t n = p_quotes.size();
+    m_types.reserve(n);
+    m_spots.assign(n, p_S0);
+    m_strikes.reserve(n);
+    m_quoteExpiries.reserve(n);
+    m_rates.reserve(n);
+    m_dividends.reserve(n);
+    m_marketPrices.reserve(n);
+    m_weights.reserve(n);
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        const OptionQuote & quote = p_quotes[j];
+
+        if (m_expiries.empty() || quote.expiry != m_expiries.back())
+        {
+            m_expiries.push_back(quote.expiry);
+            m_first.push_back(j);
+        }
+
+        m_types.push_back(quote.type);
+        m_strikes.push_back(quote.strike);
+        m_quoteExpiries.push_back(quote.expiry);
+        m_rates.push_back(p_r.mean(0.0, quote.expiry));
+        m_dividends.push_back(p_d.mean(0.0, quote.expiry));
+        m_marketPrices.push_back(quote.price);
+        m_weights.push_back(quote.weight);
+    }
+    m_first.push_back(n);
+
+    m_vols.resize(n);
+    m_prices.resize(n);
+    m_vegas.resize(n);
+}
+
+const std::vector<double> & VolCalibration::expiries() const { return m_expiries; }
+
+ParametersPiecewiseConstant VolCalibration::bootstrap()
+{
+    m_iterations.clear();
+
+    std::vector<double> values(m_expiries.size());
+    Solver solver(1e-10);
+    // the total variance up to the previous expiry
+    double variance = 0.0;
+
+    for (size_t i = 0; i < m_expiries.size(); ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t first = m_first[i];
+        size_t last = m_first[i + 1];
+        double T = m_expiries[i];
+        double dt = T - (i > 0 ? m_expiries[i - 1] : 0.0);
+
+        double target = 0.0;
+        for (size_t j = first; j < last; ++j)
+        {
+            target += m_weights[j] * m_marketPrices[j];
+        }
+
+        // the weighted sum of the expiry's prices, increasing in the piece's volatility
+        auto weightedPrice = [&](double p_vol) {
+            std::fill(m_vols.begin() + first, m_vols.begin() + last, std::sqrt((variance + p_vol * p_vol * dt) / T));
+            price(first, last, false);
+
+            double ret = 0.0;
+            for (size_t j = first; j < last; ++j)
+            {
+                ret += m_weights[j] * m_prices[j];
+            }
+            return ret;
+        };
+
+        try
+        {
+            values[i] = solver.brent(target, weightedPrice, s_minVol, s_maxVol);
+        }
+        catch (const std::invalid_argument &)
+        {
+            throw std::runtime_error("VolCalibration::bootstrap: no volatility matches the prices of expiry "
+                                     + std::to_string(T) + ".");
+        }
+
+        // the prices of the last evaluation need not be of the solution
+        weightedPrice(values[i]);
+        m_iterations.push_back({error(first, last), 0.0, secondsSince(start)});
+        variance += values[i] * values[i] * dt;
+    }
+
+    return ParametersPiecewiseConstant(m_expiries, std::move(values));
+}
+
+ParametersPiecewiseConstant VolCalibration::fit(const Parameters & p_initial, size_t p_maxIterations, double p_tolerance)
+{
+    m_iterations.clear();
+
+    size_t nPieces = m_expiries.size();
+    std::vector<double> dts(nPieces);
+    std::vector<double> values(nPieces);
+    for (size_t i = 0; i < nPieces; ++i)
+    {
+        double start = i > 0 ? m_expiries[i - 1] : 0.0;
+        dts[i] = m_expiries[i] - start;
+        values[i] = std::max(p_initial.RMS(start, m_expiries[i]), s_minVol);
+    }
+
+    setVols(values);
+    price(0, m_types.size(), true);
+    double currentError = error(0, m_types.size());
+    double damping = s_initialDamping;
+
+    std::vector<double> A(nPieces * nPieces);
+    std::vector<double> b(nPieces);
+    std::vector<double> trial(nPieces);
+    // the sums over the quotes of each expiry, c.f. below
+    std::vector<double> sumsSquare(nPieces);
+    std::vector<double> sumsResidual(nPieces);
+
+    for (size_t iteration = 0; iteration < p_maxIterations && currentError > 0.0; ++iteration)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // the residual of quote j of expiry p is r_j = w_j (V_j - V_j^market), its volatility
+        // sigma_j = sqrt(sum_{i <= p} v_i^2 dt_i / T_p), so that dr_j / dv_i = c_j a_i for i <= p, with c_j = w_j vega_j / (T_p sigma_j)
+        // & a_i = v_i dt_i; the normal equations J^T J & J^T r thus reduce to sums over the quotes of each expiry
+        for (size_t p = 0; p < nPieces; ++p)
+        {
+            sumsSquare[p] = 0.0;
+            sumsResidual[p] = 0.0;
+            for (size_t j = m_first[p]; j < m_first[p + 1]; ++j)
+            {
+                double c = m_weights[j] * m_vegas[j] / (m_expiries[p] * m_vols[j]);
+                sumsSquare[p] += c * c;
+                sumsResidual[p] += c * m_weights[j] * (m_prices[j] - m_marketPrices[j]);
+            }
+        }
+        // summed over the expiries from each piece on
+        for (size_t p = nPieces - 1; p-- > 0;)
+        {
+            sumsSquare[p] += sumsSquare[p + 1];
+            sumsResidual[p] += sumsResidual[p + 1];
+        }
+
+        double newError = currentError;
+        while (newError >= currentError && damping < s_maxDamping)
+        {
+            for (size_t i = 0; i < nPieces; ++i)
+            {
+                double ai = values[i] * dts[i];
+                for (size_t k = 0; k < nPieces; ++k)
+                {
+                    A[i * nPieces + k] = ai * values[k] * dts[k] * sumsSquare[std::max(i, k)];
+                }
+                A[i * nPieces + i] *= 1.0 + damping;
+                b[i] = -ai * sumsResidual[i];
+            }
+            solveLinear(A, b);
+
+            for (size_t i = 0; i < nPieces; ++i)
+            {
+                trial[i] = std::min(std::max(values[i] + b[i], s_minVol), s_maxVol);
+            }
+            setVols(trial);
+            price(0, m_types.size(), true);
+            newError = error(0, m_types.size());
+
+            damping *= newError < currentError ? 0.1 : 10.0;
+        }
+
+        if (newError >= currentError)
+        {
+            // no step decreases the error: restore the prices & vegas of the solution
+            setVols(values);
+            price(0, m_types.size(), true);
+            break;
+        }
+
+        double decrease = (currentError - newError) / currentError;
+        double step = 0.0;
+        for (size_t i = 0; i < nPieces; ++i)
+        {
+            step = std::max(step, std::abs(trial[i] - values[i]) / values[i]);
+        }
+        values.swap(trial);
+        currentError = newError;
+        m_iterations.push_back({currentError, damping, secondsSince(start)});
+
+        if (decrease < p_tolerance || step < p_tolerance)
+        {
+            break;
+        }
+    }
+
+    return ParametersPiecewiseConstant(m_expiries, std::move(values));
+}
+
+const std::vector<CalibrationIteration> & VolCalibration::iterations() const { return m_iterations; }
+
+double VolCalibration::error(const Parameters & p_vol)
+{
+    std::vector<double> values(m_expiries.size());
+    for (size_t i = 0; i < m_expiries.size(); ++i)
+    {
+        values[i] = p_vol.RMS(i > 0 ? m_expiries[i - 1] : 0.0, m_expiries[i]);
+    }
+
+    setVols(values);
+    price(0, m_types.size(), false);
+    return error(0, m_types.size());
+}
+
+void VolCalibration::setVols(const std::vector<double> & p_values)
+{
+    double variance = 0.0;
+    double start = 0.0;
+
+    for (size_t i = 0; i < m_expiries.size(); ++i)
+    {
+        variance += p_values[i] * p_values[i] * (m_expiries[i] - start);
+        start = m_expiries[i];
+        std::fill(m_vols.begin() + m_first[i], m_vols.begin() + m_first[i + 1], std::sqrt(variance / start));
+    }
+}
+
+void VolCalibration::price(size_t p_first, size_t p_last, bool p_withVegas)
+{
+    size_t n = p_last - p_first;
+
+    BSBatchInputs inputs{Span<const OptionType>(m_types).subspan(p_first, n),
+                         Span<const double>(m_spots).subspan(p_first, n),
+                         Span<const double>(m_strikes).subspan(p_first, n),
+                         Span<const double>(m_quoteExpiries).subspan(p_first, n),
+                         Span<const double>(m_rates).subspan(p_first, n),
+                         Span<const double>(m_dividends).subspan(p_first, n),
+                         Span<const double>(m_vols).subspan(p_first, n)};
+    BSBatchOutputs outputs{Span<double>(m_prices).subspan(p_first, n), {},
+                           p_withVegas ? Span<double>(m_vegas).subspan(p_first, n) : Span<double>()};
+
+    blackScholesBatch(inputs, outputs, m_nThreads);
+}
+
+double VolCalibration::error(size_t p_first, size_t p_last) const
+{
+    double ret = 0.0;
+    for (size_t j = p_first; j < p_last; ++j)
+    {
+        double residual = m_weights[j] * (m_prices[j] - m_marketPrices[j]);
+        ret += residual * residual;
+    }
+    return ret;
+}
+
+} // namespace der
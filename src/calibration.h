@@ -0,0 +1,122 @@
+/** \file calibration.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Fitting term structures to market quotes.
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "bsbatch.h"
+#include "parameters.h"
+
+namespace der
+{
+
+//! \brief A market quote of a European option.
+struct OptionQuote
+{
+    OptionType type;
+    double strike;
+    double expiry;
+    double price;
+    //! \brief The weight of the quote's price residual, e.g. the inverse of its bid-ask spread.
+    double weight{1.0};
+};
+
+//! \brief The progress of a calibration @ one of its iterations.
+struct CalibrationIteration
+{
+    //! \brief The weighted sum of the squared price residuals: of the expiry solved for a bootstrap, of all the quotes for a fit.
+    double error;
+    //! \brief The Levenberg-Marquardt damping, 0 for a bootstrap.
+    double damping;
+    //! \brief The wall time spent on the iteration.
+    double seconds;
+};
+
+//! \brief Calibrates a piecewise-constant Black-Scholes volatility, a piece per quoted expiry, to the prices of European options.
+//! The bootstrap solves for the pieces expiry after expiry, each matching the weighted sum of the prices of its expiry, via Brent's
+//! method. The fit minimizes the weighted squared price residuals of all the quotes jointly, via Levenberg-Marquardt, with the
+//! Jacobian from the vegas. Either way the quotes are priced in batches, c.f. \a blackScholesBatch, spread across the threads when
+//! numerous enough.
+class VolCalibration
+{
+public:
+    //! \brief Constructor. Throws std::invalid_argument if there are no quotes or an expiry is not positive.
+    //! \param p_quotes - In any order.
+    //! \param p_S0 - The spot @ time 0.
+    //! \param p_r - The interest rate.
+    //! \param p_d - The dividend rate.
+    //! \param p_nThreads - The maximal number of threads to price with.
+    VolCalibration(std::vector<OptionQuote> p_quotes, double p_S0, const Parameters & p_r, const Parameters & p_d,
+                   size_t p_nThreads = std::thread::hardware_concurrency());
+
+    //! \brief The quoted expiries, in increasing order: the right ends of the pieces.
+    const std::vector<double> & expiries() const;
+
+    //! \brief Bootstraps the volatility. Throws std::runtime_error if the prices of an expiry cannot be matched by a volatility
+    //! within [0.1%, 500%].
+    //! \return
+    ParametersPiecewiseConstant bootstrap();
+
+    //! \brief Fits the volatility to all the quotes jointly.
+    //! \param p_initial - The initial guess, its RMS over each piece in particular, e.g. the bootstrapped volatility.
+    //! \param p_maxIterations
+    //! \param p_tolerance - The relative decrease of the error, or the relative step of the values, below which an iteration ends
+    //! the fit.
+    //! \return
+    ParametersPiecewiseConstant fit(const Parameters & p_initial, size_t p_maxIterations = 50, double p_tolerance = 1e-10);
+
+    //! \brief The iterations of the last bootstrap or fit.
+    const std::vector<CalibrationIteration> & iterations() const;
+
+    //! \brief The weighted sum of the squared price residuals of all the quotes.
+    //! \param p_vol
+    //! \return
+    double error(const Parameters & p_vol);
+
+private:
+    //! \brief Sets the volatilities of the quotes to those implied by the pieces' values.
+    void setVols(const std::vector<double> & p_values);
+    //! \brief Prices the quotes [\p p_first, \p p_last) @ their current volatilities.
+    void price(size_t p_first, size_t p_last, bool p_withVegas);
+    //! \brief The weighted sum of the squared price residuals of the quotes [\p p_first, \p p_last), as last priced.
+    double error(size_t p_first, size_t p_last) const;
+
+    size_t m_nThreads;
+
+    //! \brief The expiries & the quotes of each, from m_first[i] to m_first[i + 1].
+    std::vector<double> m_expiries;
+    std::vector<size_t> m_first;
+
+    //! \name The quotes, sorted by expiry, as arrays
+    //!@{
+    std::vector<OptionType> m_types;
+    std::vector<double> m_spots;
+    std::vector<double> m_strikes;
+    std::vector<double> m_quoteExpiries;
+    std::vector<double> m_rates;
+    std::vector<double> m_dividends;
+    std::vector<double> m_marketPrices;
+    std::vector<double> m_weights;
+    //!@}
+
+    //! \name The working arrays
+    //!@{
+    std::vector<double> m_vols;
+    std::vector<double> m_prices;
+    std::vector<double> m_vegas;
+    //!@}
+
+    std::vector<CalibrationIteration> m_iterations;
+};
+
+} // namespace der
+
+#endif // CALIBRATION_H
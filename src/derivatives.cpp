@@ -6,7 +6,6 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <iostream>
 
 #include "derivatives.h"
 
@@ -84,12 +83,6 @@ double BSCall::operator()(BSFormula::p p_r, BSFormula::p p_d, BSFormula::p p_T,
     double S0 = p_S0.value_or(m_S0.value());
     double K = p_K.value_or(m_K.value());
 
-    auto params = {r, d, T, sigma, S0, K};
-    if (std::any_of(params.begin(), params.end(), [](const auto & el) { return std::abs(el) < 1e-12; }))
-    {
-        std::cerr << "BSCall::operator::Warning: some parameters zero. Is this intentional?";
-    }
-
     return BSCallFormula(r, d, T, sigma, S0, K);
 }
 
@@ -98,9 +91,9 @@ double BSCall::operator()(double p_sigma) const { return BSCallFormula(*m_r, *m_
 double BSCall::vega(double p_sigma) const
 {
     double std = p_sigma * std::sqrt(*m_T);
-    static double logSK = std::log(*m_S0 / *m_K);
+    double logSK = std::log(*m_S0 / *m_K);
     double d1 = (logSK + (*m_r - *m_d) * (*m_T) + 0.5 * std * std) / std;
-    return std::exp(-1. * (*m_d) * (*m_T)) * (*m_S0) * std::sqrt(*m_T) * cumulativeGaussian(d1);
+    return std::exp(-1. * (*m_d) * (*m_T)) * (*m_S0) * std::sqrt(*m_T) * gaussianDensity(d1);
 }
 
 double BSCall::BSCallFormula(const double p_r, const double p_d, const double p_T, const double p_sigma, const double p_S0, const double p_K)
@@ -122,12 +115,6 @@ double BSPut::operator()(BSFormula::p p_r, BSFormula::p p_d, BSFormula::p p_T, B
     double S0 = p_S0.value_or(m_S0.value());
     double K = p_K.value_or(m_K.value());
 
-    auto params = {r, d, T, sigma, S0, K};
-    if (std::any_of(params.begin(), params.end(), [](const auto & el) { return std::abs(el) < 1e-12; }))
-    {
-        std::cerr << "BSCall::operator::Warning: some parameters zero. Is this intentional?";
-    }
-
     return BSPutFormula(r, d, T, sigma, S0, K);
 }
 
@@ -136,9 +123,9 @@ double BSPut::operator()(double p_sigma) const { return BSPutFormula(*m_r, *m_d,
 double BSPut::vega(double p_sigma) const
 {
     double std = p_sigma * std::sqrt(*m_T);
-    static double logSK = std::log(*m_S0 / *m_K);
+    double logSK = std::log(*m_S0 / *m_K);
     double d1 = (logSK + (*m_r - *m_d) * (*m_T) + 0.5 * std * std) / std;
-    return std::exp(-1. * (*m_d) * (*m_T)) * (*m_S0) * std::sqrt(*m_T) * cumulativeGaussian(d1);
+    return std::exp(-1. * (*m_d) * (*m_T)) * (*m_S0) * std::sqrt(*m_T) * gaussianDensity(d1);
 }
 
 double BSPut::BSPutFormula(const double p_r, const double p_d, const double p_T, const double p_sigma, const double p_S0, const double p_K)
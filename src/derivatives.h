@@ -172,13 +172,9 @@ T normalDist(size_t p_seed)
 template <typename T>
 T normalDistImpl(size_t p_seed)
 {
-    thread_local std::random_device rDev;
-    if (p_seed == std::numeric_limits<size_t>::max())
-    {
-        // The generator is seeded from the implementation-defined device - this should be /dev/random
-        p_seed = rDev();
-    }
-    thread_local std::mt19937_64 rng{p_seed};
+    // The generator is seeded once per thread, from the implementation-defined device - this should be /dev/random - by default.
+    // NOTE: the device is only read then, a read per call would cost a system call per number
+    thread_local std::mt19937_64 rng{p_seed == std::numeric_limits<size_t>::max() ? std::random_device{}() : p_seed};
     thread_local std::normal_distribution<T> Ndist;
 
     return Ndist(rng);
@@ -3,6 +3,8 @@
  * \date 4/2019
  */
 
+#include <stdexcept>
+
 #include "exoticengine.h"
 
 namespace der
@@ -28,10 +30,18 @@ ExoticEngine::ExoticEngine(std::unique_ptr<PathDependent> p_product, Parameters
     precalculate();
 }
 
-void ExoticEngine::precalculate()
+void ExoticEngine::precalculate() { m_discounts = discounts(std::move(m_discounts)); }
+
+std::vector<double> ExoticEngine::discounts(std::vector<double> && p_times) const
 {
     // fill out the discounts using the in-place discrete cashflow times
-    std::for_each(m_discounts.begin(), m_discounts.end(), [this](auto & elem) { elem = std::exp(-m_r.integral(0.0, elem)); });
+    std::for_each(p_times.begin(), p_times.end(), [this](auto & elem) { elem = discount(m_r.integral(0.0, elem)); });
+    return std::move(p_times);
+}
+
+double ExoticEngine::presentValue(Span<const CashFlow> p_cashflows, const std::vector<double> & p_discounts)
+{
+    return presentValue<CashFlow, double>(p_cashflows, p_discounts);
 }
 
 ExoticEngine::ExoticEngine(const ExoticEngine & p_other)
@@ -56,19 +66,9 @@ double ExoticEngine::doOnePath(const std::vector<double> & p_spots) const
     // spots are passed into the products
     // the price of one path is the weighted(by the discounts) sum of amounts
 
-    m_cashflows = m_pProduct->cashFlows(p_spots, std::move(m_cashflows));
+    size_t nFlows = m_pProduct->cashFlows(p_spots, m_cashflows);
 
-    double val = 0.0;
-
-    // using TimeIndex instead of scalar product cash-flows * discounts
-    // since discounts are pre-calculated and sized to MAX number of cash-flows
-    // - the actual can be lower
-    for (const auto & cashflow : m_cashflows)
-    {
-        val += cashflow.amount * m_discounts[cashflow.timeIndex];
-    }
-
-    return val;
+    return presentValue({m_cashflows.data(), nFlows}, m_discounts);
 }
 
 void ExoticEngine::doSimulation(StatisticsBase & p_gatherer, size_t p_numberOfPaths) const
@@ -87,4 +87,52 @@ void ExoticEngine::doSimulation(StatisticsBase & p_gatherer, size_t p_numberOfPa
     }
 }
 
+void ExoticEngine::doSimulation(StatisticsControlVariate & p_gatherer, const PathDependent & p_control, size_t p_numberOfPaths) const
+{
+    if (p_control.lookAtTimes() != m_pProduct->lookAtTimes())
+    {
+        throw std::invalid_argument("ExoticEngine::doSimulation: the control must look at the same times as the product.");
+    }
+
+    std::vector<double> spots(m_pProduct->lookAtTimes().size());
+
+    // the control's own discounting & scratchpad
+    std::vector<double> controlDiscounts = discounts(p_control.possibleCashFlowTimes());
+    std::vector<CashFlow> controlCashflows(p_control.maxNumberOfCashFlows());
+
+    double value;
+    double controlValue;
+
+    for (size_t i = 0; i < p_numberOfPaths; ++i)
+    {
+        spots = path(std::move(spots));
+        value = doOnePath(spots);
+
+        size_t nControlFlows = p_control.cashFlows(spots, controlCashflows);
+        controlValue = presentValue({controlCashflows.data(), nControlFlows}, controlDiscounts);
+
+        p_gatherer.dumpOneResult(value, controlValue);
+    }
+}
+
+void ExoticEngine::doSimulation(StatisticsMultiple & p_gatherer, size_t p_numberOfPaths) const
+{
+    std::vector<double> spots(m_pProduct->lookAtTimes().size());
+    std::vector<double> values(m_pProduct->numberOfProducts());
+
+    for (size_t i = 0; i < p_numberOfPaths; ++i)
+    {
+        // the path is generated once for all the products
+        spots = path(std::move(spots));
+
+        for (size_t j = 0; j < values.size(); ++j)
+        {
+            size_t nFlows = m_pProduct->productCashFlows(j, spots, m_cashflows);
+            values[j] = presentValue({m_cashflows.data(), nFlows}, m_discounts);
+        }
+
+        p_gatherer.dumpOneResult(values);
+    }
+}
+
 } // namespace der
@@ -12,12 +12,18 @@
 #include <cmath>
 #include <memory>
 #include <numeric>
+#include <stdexcept>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "aad.h"
+#include "localvol.h"
 #include "parameters.h"
 #include "pathdependent.h"
+#include "process.h"
 #include "random.h"
+#include "span.h"
 #include "statistics.h"
 
 namespace der
@@ -25,6 +31,7 @@ namespace der
 
 //! \brief A generalized option pricing engine.
 //! The process is provided by sub-classing this class and implementing the \p path method.
+//! To price several products on the same paths, pass a \a PathDependentMultiple as the product.
 class ExoticEngine
 {
 public:
@@ -53,14 +60,43 @@ public:
     //! \param p_numberOfPaths
     void doSimulation(StatisticsBase & p_gatherer, size_t p_numberOfPaths) const;
 
+    //! \brief Performs the whole simulation, evaluating \p p_control on the same paths as the engine's product.
+    //! \param p_gatherer
+    //! \param p_control - The control variate, must look at the same times as the engine's product.
+    //! \param p_numberOfPaths
+    void doSimulation(StatisticsControlVariate & p_gatherer, const PathDependent & p_control, size_t p_numberOfPaths) const;
+
+    //! \brief Performs the whole simulation, evaluating each constituent of the product on the same paths.
+    //! Feeds one lane per constituent to the gatherer, c.f. \a PathDependentMultiple.
+    //! \param p_gatherer
+    //! \param p_numberOfPaths
+    void doSimulation(StatisticsMultiple & p_gatherer, size_t p_numberOfPaths) const;
+
 protected:
+    //! \brief Discount factors for \p p_times given the interest rate \p m_r.
+    //! \param p_times
+    //! \return \p p_times mutated in-place to discounts.
+    std::vector<double> discounts(std::vector<double> && p_times) const;
+
+    //! \brief The discount factor given the integral of the interest rate, on plain doubles or on the \a aad::Tape.
+    template <typename Number>
+    static Number discount(const Number & p_rateIntegral);
+
+    //! \brief The present value of \p p_cashflows given the pre-calculated \p p_discounts.
+    static double presentValue(Span<const CashFlow> p_cashflows, const std::vector<double> & p_discounts);
+    //! \brief The present value of \p p_cashflows given the pre-calculated \p p_discounts, on plain doubles or on the tape.
+    //! \tparam Flow - \a CashFlow or \a AADCashFlow.
+    template <typename Flow, typename Number>
+    static Number presentValue(Span<const Flow> p_cashflows, const std::vector<Number> & p_discounts);
+
     std::unique_ptr<PathDependent> m_pProduct{nullptr};
 
     Parameters m_r;
     //! \brief pre-calculated discounts
     std::vector<double> m_discounts;
 
-    //! \brief used as scratchpad for in-place calculations
+    //! \brief used as scratchpad for in-place calculations, sized once to the product's maximum number of cash-flows
+    //! NOTE: hence an engine per thread - which copies of engines are.
     mutable std::vector<CashFlow> m_cashflows;
 
 private:
@@ -68,13 +104,48 @@ private:
     void precalculate();
 };
 
+//! \brief The Monte-Carlo estimators of the Greeks.
+enum class GreeksMethod
+{
+    //! \brief Differentiates the cash-flows along the path - for Lipschitz payoffs, e.g. calls & Asians.
+    Pathwise,
+    //! \brief Differentiates the density of the path & weights the cash-flows with it - for discontinuous payoffs, e.g. digitals.
+    LikelihoodRatio
+};
+
+//! \brief The price along with its sensitivities to the inputs, bucketed over the term structures.
+struct AADRisk
+{
+    double price;
+    //! \brief The sensitivity to the spot @ time 0.
+    double delta;
+    //! \brief The end times of the buckets, the first bucket starting at 0.
+    std::vector<double> bucketTimes;
+    //! \brief The sensitivities to the mean rate over each bucket.
+    std::vector<double> rates;
+    //! \brief The sensitivities to the mean dividend rate over each bucket.
+    std::vector<double> dividends;
+    //! \brief The sensitivities to the root-mean-square vol over each bucket. Their sum is the parallel vega.
+    std::vector<double> vols;
+};
+
 //! \brief A concrete implementation of an options pricing engine using a Black-Scholes (i.e. log-Wiener) process.
+//! A thin run-time polymorphic wrapper of \a BSProcess; c.f. \a Engine for the fully static alternative.
 template <typename Generator>
 class ExoticBSEngine : public ExoticEngine
 {
 public:
-    ExoticBSEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0);
-    ExoticBSEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0);
+    //! \brief Constructor.
+    //! \param p_product
+    //! \param p_r - The interest rate.
+    //! \param p_d - The dividend rate.
+    //! \param p_vol - The volatility.
+    //! \param p_S0 - The spot @ time 0.
+    //! \param p_generator - The generator, its current state determines the draws.
+    ExoticBSEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0,
+                   Generator p_generator = Generator{});
+    ExoticBSEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0,
+                   Generator p_generator = Generator{});
 
     ExoticBSEngine(const ExoticBSEngine &) = default;
     ExoticBSEngine(ExoticBSEngine &&) = default;
@@ -87,85 +158,533 @@ public:
     //! \return Modified \p p_spots in-place.
     std::vector<double> path(std::vector<double> && p_spots) const override;
 
+    //! \brief Evolves the Black-Scholes process over the look-at times, driven by the gaussians provided.
+    //! Allows for driving the engine with draws from elsewhere, e.g. common random numbers across scenarios.
+    //! \param p_gaussians - One per look-at time.
+    //! \return The spots, overwriting \p p_gaussians in-place.
+    std::vector<double> evolve(std::vector<double> && p_gaussians) const;
+
+    //! \brief Performs the whole simulation, gathering the Greeks along with the price at the cost of a single run.
+    //! The lanes fed to the gatherer are (price, delta, vega) for each constituent product in turn, c.f. \a PathDependentMultiple.
+    //! Vega is the sensitivity to a parallel shift of the volatility.
+    //! \param p_gatherer
+    //! \param p_numberOfPaths
+    //! \param p_method - \a GreeksMethod::LikelihoodRatio requires a look-at time after time 0: the spot's density is that of the
+    //! first random one, the spots before it, e.g. @ time 0, are differentiated pathwise. Throws std::invalid_argument if there is
+    //! none.
+    void doSimulationGreeks(StatisticsMultiple & p_gatherer, size_t p_numberOfPaths, GreeksMethod p_method) const;
+
+    //! \brief Performs the whole simulation in blocks of paths, evolving all the paths of a block one look-at time after another and
+    //! folding the spots into the product's running states, c.f. \a StreamingPathDependent. The paths are never held whole: the
+    //! memory is \f$O(N_{block})\f$ rather than \f$O(N_{block} N_{dates})\f$ and stays in cache.
+    //! The draws are taken date by date for the whole block, so the paths differ from \a doSimulation's; generators pairing
+    //! successive draws, i.e. \a AntiThetic, would pair the dates rather than the paths.
+    //! \param p_gatherer
+    //! \param p_numberOfPaths
+    //! \param p_blockSize - The number of paths evolved together.
+    void doSimulationStreaming(StatisticsBase & p_gatherer, size_t p_numberOfPaths, size_t p_blockSize = 1024) const;
+
+    //! \brief Performs the whole simulation, getting the sensitivities to every bucket of the parameters by adjoint differentiation.
+    //! The buckets are delimited by the look-at & the possible cash-flow times, over which the parameters enter the price through
+    //! their mean (the rates) or RMS (the vol) only. The pre-calculation is recorded on the \a aad::Tape once, each path is recorded
+    //! after it, swept back & rewound, so the tape stays small and the cost is a small multiple of \a doSimulation's.
+    //! Requires the product to implement \a PathDependent::cashFlowsAAD.
+    //! \param p_numberOfPaths
+    //! \return
+    AADRisk doSimulationAAD(size_t p_numberOfPaths) const;
+
 protected:
     //! \brief The RNG provided.
     Generator m_generator;
 
     const Parameters m_d{};
     const Parameters m_vol{};
-    const double m_logS0{0.0};
+
+    //! \brief The process over the product's look-at times, pre-calculated.
+    const BSProcess m_process;
 
 private:
-    //! \brief Pre-calculates the drifts \p m_drifts and stdev's \p m_stds given the parameters above.
+    //! \brief Passes the Brownian bridges between the look-at times to the product, c.f. \a PathDependent::setBridge.
     void precalculate();
+};
+
+//! \brief An options pricing engine using a local volatility process: \f$d\log S = (r - d - \frac{1}{2}\sigma^2(t, \log S))dt +
+//! \sigma(t, \log S) dW\f$.
+//! The look-at times are refined into sub-steps of at most \p p_maxStepSize, over which the log-spot is evolved with an Euler
+//! scheme. The surface is interpolated in time once, at construction, so only a linear interpolation in log-spot remains per
+//! step and path.
+template <typename Generator>
+class ExoticLocalVolEngine : public ExoticEngine
+{
+public:
+    //! \brief Constructor. Throws std::invalid_argument unless the step size is positive & finite & the product's look-at times
+    //! increasing, the first non-negative.
+    //! \param p_product
+    //! \param p_r - The interest rate.
+    //! \param p_d - The dividend rate.
+    //! \param p_vol - The local volatility surface.
+    //! \param p_S0 - The spot @ time 0.
+    //! \param p_maxStepSize - The largest Euler time step allowed.
+    //! \param p_generator - The generator, its current state determines the draws.
+    ExoticLocalVolEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d, LocalVolSurface p_vol, double p_S0,
+                         double p_maxStepSize, Generator p_generator = Generator{});
+    ExoticLocalVolEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d, LocalVolSurface p_vol,
+                         double p_S0, double p_maxStepSize, Generator p_generator = Generator{});
+
+    //! \brief Implements the local volatility process for the spot with the class' parameters.
+    //! \param p_spots
+    //! \return Modified \p p_spots in-place.
+    std::vector<double> path(std::vector<double> && p_spots) const override;
+
+protected:
+    //! \brief The RNG provided.
+    Generator m_generator;
 
-    // helpers
-    //! \brief Cached relevant spot times to the product's cash-flow function.
-    mutable std::vector<double> m_times;
+    const Parameters m_d{};
+    const LocalVolSurface m_vol;
+    const double m_logS0{0.0};
+    const double m_maxStepSize{0.0};
 
-    // pre-calculated
-    mutable std::vector<double> m_drifts;
-    mutable std::vector<double> m_stds;
+private:
+    //! \brief Pre-calculates the sub-steps, their drifts \p m_drifts and the vol slices \p m_slices.
+    void precalculate();
+
+    // pre-calculated, per sub-step
+    std::vector<double> m_drifts;
+    std::vector<double> m_dts;
+    std::vector<double> m_sqrtDts;
+    //! \brief The surface interpolated to the start of each sub-step, row-major.
+    std::vector<double> m_slices;
+    //! \brief The number of sub-steps up to and including each look-at time.
+    std::vector<size_t> m_stepEnds;
+
+    //! \brief used as scratchpad for the gaussians of all the sub-steps
+    mutable std::vector<double> m_gaussians;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTATION
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// ExoticEngine
+
+template <typename Number>
+Number ExoticEngine::discount(const Number & p_rateIntegral)
+{
+    using std::exp;
+    return exp(-p_rateIntegral);
+}
+
+template <typename Flow, typename Number>
+Number ExoticEngine::presentValue(Span<const Flow> p_cashflows, const std::vector<Number> & p_discounts)
+{
+    Number val(0.0);
+
+    // using TimeIndex instead of scalar product cash-flows * discounts
+    // since discounts are pre-calculated and sized to MAX number of cash-flows
+    // - the actual can be lower
+    for (const auto & cashflow : p_cashflows)
+    {
+        val += cashflow.amount * p_discounts[cashflow.timeIndex];
+    }
+
+    return val;
+}
+
 // ExoticBSEngine
 
 template <typename Generator>
-ExoticBSEngine<Generator>::ExoticBSEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0)
+ExoticBSEngine<Generator>::ExoticBSEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol,
+                                          double p_S0, Generator p_generator)
+    : ExoticEngine(p_product, p_r)
+    , m_generator(std::move(p_generator))
+    , m_d(std::move(p_d))
+    , m_vol(std::move(p_vol))
+    , m_process(m_pProduct->lookAtTimes(), m_r, m_d, m_vol, p_S0)
+{
+    precalculate();
+}
+
+template <typename Generator>
+ExoticBSEngine<Generator>::ExoticBSEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d, Parameters p_vol,
+                                          double p_S0, Generator p_generator)
+    : ExoticEngine(std::move(p_product), p_r)
+    , m_generator(std::move(p_generator))
+    , m_d(std::move(p_d))
+    , m_vol(std::move(p_vol))
+    , m_process(m_pProduct->lookAtTimes(), m_r, m_d, m_vol, p_S0)
+{
+    precalculate();
+}
+
+template <typename Generator>
+void ExoticBSEngine<Generator>::precalculate()
+{
+    std::vector<double> variances(m_process.dimension());
+    std::transform(m_process.stds().begin(), m_process.stds().end(), variances.begin(), [](double std) { return std * std; });
+
+    m_pProduct->setBridge(std::exp(m_process.logS0()), variances);
+}
+
+template <typename Generator>
+std::vector<double> ExoticBSEngine<Generator>::path(std::vector<double> && p_spots) const
+{
+    return evolve(m_generator.gaussians(std::move(p_spots)));
+}
+
+template <typename Generator>
+std::vector<double> ExoticBSEngine<Generator>::evolve(std::vector<double> && p_gaussians) const
+{
+    return m_process.evolve(std::move(p_gaussians));
+}
+
+template <typename Generator>
+void ExoticBSEngine<Generator>::doSimulationGreeks(StatisticsMultiple & p_gatherer, size_t p_numberOfPaths,
+                                                   GreeksMethod p_method) const
+{
+    const auto & drifts = m_process.drifts();
+    const auto & stds = m_process.stds();
+    const auto & volIntegrals = m_process.volIntegrals();
+
+    size_t nDates = m_process.dimension();
+    size_t nProducts = m_pProduct->numberOfProducts();
+    double S0 = std::exp(m_process.logS0());
+
+    // the spot @ time 0 enters the density of the path through the first random look-at time only; it enters the spots before it,
+    // e.g. @ time 0, directly, which the likelihood ratio then differentiates pathwise
+    size_t first = static_cast<size_t>(std::find_if(stds.begin(), stds.end(), [](double p_std) { return p_std > 0.0; }) - stds.begin());
+    if (p_method == GreeksMethod::LikelihoodRatio && first == nDates)
+    {
+        throw std::invalid_argument("ExoticBSEngine::doSimulationGreeks: the likelihood ratio needs a look-at time after time 0.");
+    }
+
+    std::vector<double> gaussians(nDates);
+    std::vector<double> spots(nDates);
+    std::vector<double> deltaTangents(nDates);
+    std::vector<double> vegaTangents(nDates);
+    std::vector<double> fixedTangents(nDates, 0.0);
+    std::vector<double> values(3 * nProducts);
+
+    for (size_t path = 0; path < p_numberOfPaths; ++path)
+    {
+        gaussians = m_generator.gaussians(std::move(gaussians));
+
+        double logS = m_process.logS0();
+        // d log S / d vol along the path
+        double logSVega = 0.0;
+        // the likelihood ratio weights: d log density / d parameter
+        double deltaWeight = first < nDates ? gaussians[first] / (S0 * stds[first]) : 0.0;
+        double vegaWeight = 0.0;
+
+        for (size_t i = 0; i < nDates; ++i)
+        {
+            logS += drifts[i] + stds[i] * gaussians[i];
+            spots[i] = std::exp(logS);
+
+            // the drift moves by -int(vol), the stdev by int(vol) / stdev
+            double stdVega = stds[i] > 0.0 ? volIntegrals[i] / stds[i] : 0.0;
+            logSVega += -volIntegrals[i] + stdVega * gaussians[i];
+
+            deltaTangents[i] = spots[i] / S0;
+            vegaTangents[i] = spots[i] * logSVega;
+            if (i < first)
+            {
+                fixedTangents[i] = deltaTangents[i];
+            }
+
+            if (stds[i] > 0.0)
+            {
+                vegaWeight += (-volIntegrals[i] * gaussians[i] + stdVega * (gaussians[i] * gaussians[i] - 1.0)) / stds[i];
+            }
+        }
+
+        for (size_t j = 0; j < nProducts; ++j)
+        {
+            size_t nFlows = m_pProduct->productCashFlows(j, spots, m_cashflows);
+            double price = presentValue({m_cashflows.data(), nFlows}, m_discounts);
+            values[3 * j] = price;
+
+            if (p_method == GreeksMethod::Pathwise)
+            {
+                nFlows = m_pProduct->productCashFlowDerivatives(j, spots, deltaTangents, m_cashflows);
+                values[3 * j + 1] = presentValue({m_cashflows.data(), nFlows}, m_discounts);
+
+                nFlows = m_pProduct->productCashFlowDerivatives(j, spots, vegaTangents, m_cashflows);
+                values[3 * j + 2] = presentValue({m_cashflows.data(), nFlows}, m_discounts);
+            }
+            else
+            {
+                double fixedDelta = 0.0;
+                if (first > 0)
+                {
+                    nFlows = m_pProduct->productCashFlowDerivatives(j, spots, fixedTangents, m_cashflows);
+                    fixedDelta = presentValue({m_cashflows.data(), nFlows}, m_discounts);
+                }
+
+                values[3 * j + 1] = price * deltaWeight + fixedDelta;
+                values[3 * j + 2] = price * vegaWeight;
+            }
+        }
+
+        p_gatherer.dumpOneResult(values);
+    }
+}
+
+template <typename Generator>
+void ExoticBSEngine<Generator>::doSimulationStreaming(StatisticsBase & p_gatherer, size_t p_numberOfPaths, size_t p_blockSize) const
+{
+    const auto * product = dynamic_cast<const StreamingPathDependent *>(m_pProduct.get());
+    if (product == nullptr)
+    {
+        throw std::invalid_argument("ExoticBSEngine::doSimulationStreaming: the product cannot be evaluated date by date.");
+    }
+
+    const auto & drifts = m_process.drifts();
+    const auto & stds = m_process.stds();
+    size_t nDates = m_process.dimension();
+    size_t stateSize = product->stateSize();
+
+    p_blockSize = std::max(std::min(p_blockSize, p_numberOfPaths), size_t{1});
+    std::vector<double> gaussians(p_blockSize);
+    std::vector<double> logSpots(p_blockSize);
+    std::vector<double> spots(p_blockSize);
+    std::vector<double> states(stateSize * p_blockSize);
+
+    for (size_t done = 0; done < p_numberOfPaths; done += gaussians.size())
+    {
+        // the last block may be partial; shrinking keeps the memory
+        size_t nPaths = std::min(p_blockSize, p_numberOfPaths - done);
+        gaussians.resize(nPaths);
+        Span<double> blockStates(states.data(), stateSize * nPaths);
+
+        product->init(blockStates);
+        std::fill(logSpots.begin(), logSpots.begin() + nPaths, m_process.logS0());
+
+        for (size_t i = 0; i < nDates; ++i)
+        {
+            gaussians = m_generator.gaussians(std::move(gaussians));
+
+            for (size_t p = 0; p < nPaths; ++p)
+            {
+                logSpots[p] += drifts[i] + stds[i] * gaussians[p];
+                spots[p] = std::exp(logSpots[p]);
+            }
+
+            product->observe(i, {spots.data(), nPaths}, blockStates);
+        }
+
+        for (size_t p = 0; p < nPaths; ++p)
+        {
+            size_t nFlows = product->finish(blockStates, p, m_cashflows);
+            p_gatherer.dumpOneResult(presentValue({m_cashflows.data(), nFlows}, m_discounts));
+        }
+    }
+}
+
+template <typename Generator>
+AADRisk ExoticBSEngine<Generator>::doSimulationAAD(size_t p_numberOfPaths) const
+{
+    const auto & times = m_process.times();
+
+    AADRisk ret{0.0, 0.0, times, {}, {}, {}};
+
+    auto flowTimes = m_pProduct->possibleCashFlowTimes();
+    auto & buckets = ret.bucketTimes;
+    buckets.insert(buckets.end(), flowTimes.begin(), flowTimes.end());
+    std::sort(buckets.begin(), buckets.end());
+    buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+    buckets.erase(buckets.begin(), std::upper_bound(buckets.begin(), buckets.end(), 0.0));
+
+    size_t nBuckets = buckets.size();
+    size_t nDates = times.size();
+
+    // rewinds the tape on leaving, also when the product throws
+    aad::TapeScope scope;
+    aad::Tape & tape = scope.tape();
+
+    // the inputs
+    aad::Number S0(std::exp(m_process.logS0()));
+    std::vector<aad::Number> rates(nBuckets);
+    std::vector<aad::Number> dividends(nBuckets);
+    std::vector<aad::Number> vols(nBuckets);
+    std::vector<double> dts(nBuckets);
+    for (size_t b = 0; b < nBuckets; ++b)
+    {
+        double t1 = b > 0 ? buckets[b - 1] : 0.0;
+        rates[b] = m_r.mean(t1, buckets[b]);
+        dividends[b] = m_d.mean(t1, buckets[b]);
+        vols[b] = m_vol.RMS(t1, buckets[b]);
+        dts[b] = buckets[b] - t1;
+    }
+
+    // the pre-calculation of the process & of the discounts, on the tape
+    // sums the bucketed integrals of the parameters up to time p_t, returning the number of buckets consumed
+    auto integrate = [&](size_t p_bucket, double p_t, aad::Number & p_carry, aad::Number & p_variance, aad::Number & p_rate) {
+        for (; p_bucket < nBuckets && buckets[p_bucket] <= p_t; ++p_bucket)
+        {
+            p_carry += (rates[p_bucket] - dividends[p_bucket]) * dts[p_bucket];
+            p_variance += vols[p_bucket] * vols[p_bucket] * dts[p_bucket];
+            p_rate += rates[p_bucket] * dts[p_bucket];
+        }
+        return p_bucket;
+    };
+
+    aad::Number logS0 = log(S0);
+    std::vector<aad::Number> drifts(nDates);
+    std::vector<aad::Number> stds(nDates);
+    size_t bucket = 0;
+    for (size_t i = 0; i < nDates; ++i)
+    {
+        aad::Number carry(0.0);
+        aad::Number variance(0.0);
+        aad::Number rate(0.0);
+        bucket = integrate(bucket, times[i], carry, variance, rate);
+
+        std::tie(drifts[i], stds[i]) = BSProcess::step(carry, variance);
+    }
+
+    std::vector<aad::Number> discounts(flowTimes.size());
+    for (size_t k = 0; k < flowTimes.size(); ++k)
+    {
+        aad::Number carry(0.0);
+        aad::Number variance(0.0);
+        aad::Number rate(0.0);
+        integrate(0, flowTimes[k], carry, variance, rate);
+        discounts[k] = discount(rate);
+    }
+
+    aad::Tape::Mark checkpoint = tape.mark();
+
+    std::vector<double> gaussians(nDates);
+    std::vector<aad::Number> spots(nDates);
+    std::vector<AADCashFlow> flows(m_pProduct->maxNumberOfCashFlows());
+    double weight = 1.0 / p_numberOfPaths;
+
+    for (size_t path = 0; path < p_numberOfPaths; ++path)
+    {
+        gaussians = m_generator.gaussians(std::move(gaussians));
+        BSProcess::evolvePath(logS0, drifts, stds, gaussians, spots);
+
+        flows = m_pProduct->cashFlowsAAD(spots, std::move(flows));
+        aad::Number value = presentValue(Span<const AADCashFlow>(flows), discounts);
+
+        ret.price += value.value() * weight;
+
+        // the path's adjoints accumulate on the pre-calculated nodes, the path itself is no longer needed
+        value.adjoint() = weight;
+        tape.propagate(tape.mark(), checkpoint);
+        tape.rewind(checkpoint);
+    }
+
+    tape.propagate(checkpoint, scope.start());
+
+    ret.delta = S0.adjoint();
+    for (size_t b = 0; b < nBuckets; ++b)
+    {
+        ret.rates.push_back(rates[b].adjoint());
+        ret.dividends.push_back(dividends[b].adjoint());
+        ret.vols.push_back(vols[b].adjoint());
+    }
+
+    return ret;
+}
+
+// ExoticLocalVolEngine
+
+template <typename Generator>
+ExoticLocalVolEngine<Generator>::ExoticLocalVolEngine(const PathDependent & p_product, Parameters p_r, Parameters p_d,
+                                                      LocalVolSurface p_vol, double p_S0, double p_maxStepSize,
+                                                      Generator p_generator)
     : ExoticEngine(p_product, p_r)
+    , m_generator(std::move(p_generator))
     , m_d(std::move(p_d))
     , m_vol(std::move(p_vol))
     , m_logS0(std::log(p_S0))
-    , m_times(m_pProduct->lookAtTimes())
-    , m_drifts(m_times.size())
-    , m_stds(m_times.size())
+    , m_maxStepSize(p_maxStepSize)
 {
     precalculate();
 }
 
 template <typename Generator>
-ExoticBSEngine<Generator>::ExoticBSEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0)
+ExoticLocalVolEngine<Generator>::ExoticLocalVolEngine(std::unique_ptr<PathDependent> p_product, Parameters p_r, Parameters p_d,
+                                                      LocalVolSurface p_vol, double p_S0, double p_maxStepSize,
+                                                      Generator p_generator)
     : ExoticEngine(std::move(p_product), p_r)
+    , m_generator(std::move(p_generator))
     , m_d(std::move(p_d))
     , m_vol(std::move(p_vol))
     , m_logS0(std::log(p_S0))
-    , m_times(m_pProduct->lookAtTimes())
-    , m_drifts(m_times.size())
-    , m_stds(m_times.size())
+    , m_maxStepSize(p_maxStepSize)
 {
     precalculate();
 }
 
 template <typename Generator>
-void ExoticBSEngine<Generator>::precalculate()
+void ExoticLocalVolEngine<Generator>::precalculate()
 {
-    // pre-calculate the drifts and the standard deviations
-    m_stds[0] = std::sqrt(m_vol.integralSquare(0, m_times[0]));
-    m_drifts[0] = m_r.integral(0.0, m_times[0]) - m_d.integral(0.0, m_times[0]) - 0.5 * m_stds[0] * m_stds[0];
+    if (!std::isfinite(m_maxStepSize) || m_maxStepSize <= 0.0)
+    {
+        throw std::invalid_argument("ExoticLocalVolEngine: the maximal step size must be positive & finite.");
+    }
+
+    const auto & times = m_pProduct->lookAtTimes();
+    size_t nX = m_vol.numLogSpots();
+    std::vector<double> slice(nX);
 
-    for (size_t i = 1; i < m_times.size(); ++i)
+    double start = 0.0;
+    for (size_t i = 0; i < times.size(); ++i)
     {
-        m_stds[i] = std::sqrt(m_vol.integralSquare(m_times[i - 1], m_times[i]));
-        m_drifts[i] = m_r.integral(m_times[i - 1], m_times[i]) - m_d.integral(m_times[i - 1], m_times[i]) - 0.5 * m_stds[i] * m_stds[i];
+        double end = times[i];
+        // a look-at time @ 0 is the only one not after its predecessor
+        if (!(i == 0 ? end >= start : end > start))
+        {
+            throw std::invalid_argument("ExoticLocalVolEngine: the look-at times must be increasing & non-negative.");
+        }
+
+        // at least one step, unless the look-at time is @ 0
+        auto nSteps = static_cast<size_t>(std::ceil((end - start) / m_maxStepSize));
+        double dt = nSteps > 0 ? (end - start) / nSteps : 0.0;
+
+        for (size_t k = 0; k < nSteps; ++k)
+        {
+            double t1 = start + k * dt;
+            double t2 = (k + 1 == nSteps) ? end : t1 + dt;
+
+            m_drifts.push_back(m_r.integral(t1, t2) - m_d.integral(t1, t2));
+            m_dts.push_back(t2 - t1);
+            m_sqrtDts.push_back(std::sqrt(t2 - t1));
+
+            // the vol is evaluated at the start of the step - explicit Euler
+            slice = m_vol.slice(t1, std::move(slice));
+            m_slices.insert(m_slices.end(), slice.begin(), slice.end());
+        }
+
+        m_stepEnds.push_back(m_drifts.size());
+        start = end;
     }
+
+    m_gaussians.resize(m_drifts.size());
 }
 
 template <typename Generator>
-std::vector<double> ExoticBSEngine<Generator>::path(std::vector<double> && p_spots) const
+std::vector<double> ExoticLocalVolEngine<Generator>::path(std::vector<double> && p_spots) const
 {
-    p_spots = m_generator.gaussians(std::move(p_spots));
+    m_gaussians = m_generator.gaussians(std::move(m_gaussians));
 
+    size_t nX = m_vol.numLogSpots();
     double logS = m_logS0;
+    size_t step = 0;
 
-    // evolve the path, overwrites the gaussian spots in-place with the BS spots
-    for (size_t i = 0; i < m_times.size(); ++i)
+    for (size_t i = 0; i < m_stepEnds.size(); ++i)
     {
-        logS += m_drifts[i];
-        logS += m_stds[i] * p_spots[i];
+        // evolve to the next look-at time
+        for (; step < m_stepEnds[i]; ++step)
+        {
+            double sigma = m_vol.interpolate(m_slices.data() + step * nX, logS);
+
+            logS += m_drifts[step] - 0.5 * sigma * sigma * m_dts[step];
+            logS += sigma * m_sqrtDts[step] * m_gaussians[step];
+        }
 
         p_spots[i] = std::exp(logS);
     }
@@ -0,0 +1,206 @@
+/** \file impliedvol.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "impliedvol.h"
+#include "parallel.h"
+#include "simdmath.h"
+
+namespace der
+{
+
+namespace
+{
+
+//! \brief The number of options iterated in lock-step, their state kept on the stack.
+constexpr size_t s_block = 256;
+//! \brief The most options a thread takes @ once: longer runs of a single expiry are split.
+//! Runs shorter than \a s_block are merged with the next ones instead, e.g. in a chain not sorted by expiry.
+constexpr size_t s_maxTask = size_t{1} << 14;
+//! \brief The Householder steps: 3 reach the precision from the initial guess for most prices, the 4th confirms it.
+constexpr int s_steps = 4;
+
+constexpr double s_oneOverSqrt2Pi = 0.39894228040143267794;
+
+//! \brief Inverts \p p_n <= \a s_block options. Takes the arrays as restrict-qualified parameters, like the kernels of
+//! bsbatch.cpp, so that the lock-step loops vectorize without run-time overlap checks.
+//! \return The number of converged options.
+size_t solveBlock(size_t p_n, const OptionType * __restrict types, const double * __restrict prices, const double * __restrict spots,
+                  const double * __restrict strikes, const double * __restrict expiries, const double * __restrict rates,
+                  const double * __restrict dividends, double * __restrict vols, ImpliedVolStatus * __restrict statuses,
+                  double p_tolerance)
+{
+    // the state of the normalized out-of-the-money problem: b(x, s) = beta for x <= 0
+    double xs[s_block];
+    double eHalfXs[s_block];
+    double betas[s_block];
+    double logBetas[s_block];
+    double lowRegimes[s_block];
+    double ss[s_block];
+    double steps[s_block];
+    // 0 if solvable, else -1 below the intrinsic value, 1 above the maximum, 2 expired
+    double bounds[s_block];
+
+#pragma omp simd
+    for (size_t i = 0; i < p_n; ++i)
+    {
+        // an expired option has no time value to invert: flagged below, & priced @ a unit expiry meanwhile, to stay finite
+        bool expired = !(expiries[i] > 0.0);
+        double T = expired ? 1.0 : expiries[i];
+        double x = simd::log(spots[i] / strikes[i]) + (rates[i] - dividends[i]) * T;
+        double eHalfX = simd::exp(0.5 * x);
+
+        // the price normalized by the discounted geometric mean of the forward & the strike
+        double beta = prices[i] / (simd::exp(-rates[i] * T) * strikes[i] * eHalfX);
+        // an in-the-money option is worth its intrinsic value plus the out-of-the-money option's, by the put-call parity
+        double theta = types[i] == OptionType::Put ? -1.0 : 1.0;
+        beta -= std::max(theta * (eHalfX - 1.0 / eHalfX), 0.0);
+
+        // the out-of-the-money put is the call of the opposite moneyness
+        double xOtm = -std::abs(x);
+        double eHalfXOtm = simd::exp(0.5 * xOtm);
+
+        // outside of (0, e^{x / 2}) there is no solution: flagged, & replaced so that the arithmetic below stays finite
+        bounds[i] = expired ? 2.0 : (beta <= 0.0 ? -1.0 : (beta >= eHalfXOtm ? 1.0 : 0.0));
+        beta = bounds[i] == 0.0 ? beta : 0.5 * eHalfXOtm;
+
+        // the inflection point & the price there
+        double sC = std::sqrt(-2.0 * xOtm);
+        double bC = 0.5 * eHalfXOtm - simd::cumulativeGaussian(-sC) / eHalfXOtm;
+
+        // above the inflection point, the asymptotics of b as s -> infinity; below, those of ln b as s -> 0, poor close to the
+        // money so bounded by the solution @ the money from below & by the former from above, which hold there
+        double sHigh = -2.0
+                       * simd::inverseCumulativeGaussian((eHalfXOtm - beta) / (eHalfXOtm - bC)
+                                                         * simd::cumulativeGaussian(-0.5 * sC));
+        double sLow = std::sqrt(2.0 * xOtm * xOtm / (-xOtm - 4.0 * simd::log(beta / bC)));
+        double sAtm = -2.0 * simd::inverseCumulativeGaussian(0.5 - 0.5 * beta / eHalfXOtm);
+        sLow = std::min(std::max(sLow, sAtm), sHigh);
+
+        lowRegimes[i] = beta < bC ? 1.0 : 0.0;
+        xs[i] = xOtm;
+        eHalfXs[i] = eHalfXOtm;
+        betas[i] = beta;
+        logBetas[i] = simd::log(beta);
+        ss[i] = beta < bC ? sLow : sHigh;
+    }
+
+    for (int step = 0; step < s_steps; ++step)
+    {
+#pragma omp simd
+        for (size_t i = 0; i < p_n; ++i)
+        {
+            double x = xs[i];
+            double s = ss[i];
+            double h = x / s;
+            double t = 0.5 * s;
+
+            // the normalized Black function & its derivatives by s, the latter relative to the first one
+            double b = eHalfXs[i] * simd::cumulativeGaussian(h + t) - simd::cumulativeGaussian(h - t) / eHalfXs[i];
+            double b1 = s_oneOverSqrt2Pi * simd::exp(-0.5 * (h * h + t * t));
+            double b2OverB1 = h * h / s - 0.5 * t;
+            double b3OverB1 = b2OverB1 * b2OverB1 - 3.0 * h * h / (s * s) - 0.25;
+
+            // the objective ln b - ln beta below the inflection point, b - beta above
+            double low = lowRegimes[i];
+            double bOverB1 = b / b1;
+            double r1 = 1.0 / bOverB1;
+            double f = low * (simd::log(b) - logBetas[i]) + (1.0 - low) * (b - betas[i]);
+            double fPrime = low * r1 + (1.0 - low) * b1;
+            double h2 = b2OverB1 - low * r1;
+            double h3 = b3OverB1 - low * (3.0 * b2OverB1 * r1 - 2.0 * r1 * r1);
+
+            // Householder's method of the 3rd order, falling back to Newton's where the higher orders reverse the step
+            double nu = -f / fPrime;
+            double delta = nu * (1.0 + 0.5 * h2 * nu) / (1.0 + nu * (h2 + h3 * nu / 6.0));
+            delta = delta * nu > 0.0 ? delta : nu;
+
+            // kept positive, the objectives are not defined below 0
+            ss[i] = std::max(s + delta, 0.5 * s);
+            steps[i] = delta;
+        }
+    }
+
+#pragma omp simd
+    for (size_t i = 0; i < p_n; ++i)
+    {
+        bool converged = std::abs(steps[i]) <= p_tolerance * ss[i];
+        vols[i] = bounds[i] == 0.0 ? ss[i] / std::sqrt(expiries[i]) : std::numeric_limits<double>::quiet_NaN();
+        statuses[i] = bounds[i] > 1.0   ? ImpliedVolStatus::Expired
+                      : bounds[i] < 0.0 ? ImpliedVolStatus::BelowIntrinsic
+                      : bounds[i] > 0.0 ? ImpliedVolStatus::AboveMaximum
+                      : converged       ? ImpliedVolStatus::Converged
+                                        : ImpliedVolStatus::NotConverged;
+    }
+
+    size_t nConverged = 0;
+    for (size_t i = 0; i < p_n; ++i)
+    {
+        nConverged += statuses[i] == ImpliedVolStatus::Converged ? 1 : 0;
+    }
+
+    return nConverged;
+}
+
+//! \brief Inverts the options [\p p_first, \p p_last), block by block.
+size_t solveRange(const ImpliedVolInputs & p_inputs, const ImpliedVolOutputs & p_outputs, double p_tolerance, size_t p_first,
+                  size_t p_last)
+{
+    size_t ret = 0;
+    for (size_t first = p_first; first < p_last; first += s_block)
+    {
+        ret += solveBlock(std::min(s_block, p_last - first), p_inputs.types.data() + first, p_inputs.prices.data() + first,
+                          p_inputs.spots.data() + first, p_inputs.strikes.data() + first, p_inputs.expiries.data() + first,
+                          p_inputs.rates.data() + first, p_inputs.dividends.data() + first, p_outputs.vols.data() + first,
+                          p_outputs.statuses.data() + first, p_tolerance);
+    }
+    return ret;
+}
+
+} // namespace
+
+size_t impliedVolBatch(const ImpliedVolInputs & p_inputs, const ImpliedVolOutputs & p_outputs, double p_tolerance, size_t p_nThreads)
+{
+    size_t n = p_inputs.types.size();
+
+    if (p_inputs.prices.size() != n || p_inputs.spots.size() != n || p_inputs.strikes.size() != n || p_inputs.expiries.size() != n
+        || p_inputs.rates.size() != n || p_inputs.dividends.size() != n)
+    {
+        throw std::invalid_argument("impliedVolBatch: the input arrays differ in size.");
+    }
+    if (p_outputs.vols.size() != n || p_outputs.statuses.size() != n)
+    {
+        throw std::invalid_argument("impliedVolBatch: the output arrays are to be of the inputs' size.");
+    }
+
+    // the runs of a single expiry, split when long; a task takes at least a full block, whatever the expiries
+    std::vector<std::pair<size_t, size_t>> tasks;
+    for (size_t first = 0, last = 0; first < n; first = last)
+    {
+        last = first + 1;
+        while (last < n && last - first < s_maxTask
+               && (last - first < s_block || p_inputs.expiries[last] == p_inputs.expiries[last - 1]))
+        {
+            ++last;
+        }
+        tasks.emplace_back(first, last);
+    }
+
+    std::atomic<size_t> nConverged{0};
+    parallelFor(tasks.size(), p_nThreads, [&](size_t p_task) {
+        nConverged += solveRange(p_inputs, p_outputs, p_tolerance, tasks[p_task].first, tasks[p_task].second);
+    });
+
+    return nConverged;
+}
+
+} // namespace der
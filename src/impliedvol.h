@@ -0,0 +1,76 @@
+/** \file impliedvol.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * The Black-Scholes implied volatilities of arrays of options.
+ */
+
+#ifndef IMPLIEDVOL_H
+#define IMPLIEDVOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "bsbatch.h"
+#include "span.h"
+
+namespace der
+{
+
+//! \brief The outcome of the inversion of a single price.
+enum class ImpliedVolStatus : std::uint8_t
+{
+    Converged,
+    //! \brief The price is not above the intrinsic value: there is no volatility.
+    BelowIntrinsic,
+    //! \brief The price is not below the no-arbitrage maximum, i.e. the discounted forward for a call: there is no volatility.
+    AboveMaximum,
+    //! \brief The fixed number of iterations did not reach the tolerance, the volatility is the last iterate.
+    NotConverged,
+    //! \brief The expiry is not positive: the price has no time value & there is no volatility.
+    Expired
+};
+
+//! \brief The options to invert, as a structure of arrays c.f. \a BSBatchInputs, with the prices in place of the volatilities.
+//! In any order: the threads take runs of adjacent options of the same expiry, short runs merged & long ones split.
+struct ImpliedVolInputs
+{
+    Span<const OptionType> types;
+    Span<const double> prices;
+    Span<const double> spots;
+    Span<const double> strikes;
+    Span<const double> expiries;
+    Span<const double> rates;
+    Span<const double> dividends;
+};
+
+//! \brief Where the results are written, caller-owned, of the inputs' size.
+struct ImpliedVolOutputs
+{
+    //! \brief NaN for the prices outside of the no-arbitrage bounds & for the expired options.
+    Span<double> vols;
+    Span<ImpliedVolStatus> statuses;
+};
+
+//! \brief Inverts the Black-Scholes formulas for arrays of options, c.f. \a blackScholesBatch.
+//! Each price is normalized to that of the out-of-the-money option of the same strike, a function of the log-moneyness
+//! \f$x = \ln(F / K)\f$ & the total standard deviation \f$s = \sigma\sqrt{T}\f$ only. The initial guess of \f$s\f$ follows
+//! Jaeckel's closed forms (By Implication, 2006), matching the asymptotics on either side of the inflection point
+//! \f$s_c = \sqrt{2|x|}\f$.
+//! A fixed number of Householder steps of the 3rd order follow, on \f$\ln b(s)\f$ below the inflection point & on \f$b(s)\f$ above.
+//! The options are iterated in lock-step: the loops over them are branch-free & vectorized, c.f. simdmath.h.
+//! The runs of options of the same expiry are shared out among the threads, merged up to a block when short & split when long.
+//! Throws std::invalid_argument if the sizes do not match.
+//! \param p_inputs
+//! \param p_outputs
+//! \param p_tolerance - The relative tolerance on the size of the last step. The convergence being of the 4th order, the error
+//! left after it is far smaller.
+//! \param p_nThreads - The maximal number of threads to use.
+//! \return The number of converged options, the expired ones excluded.
+size_t impliedVolBatch(const ImpliedVolInputs & p_inputs, const ImpliedVolOutputs & p_outputs, double p_tolerance = 1e-8,
+                       size_t p_nThreads = std::thread::hardware_concurrency());
+
+} // namespace der
+
+#endif // IMPLIEDVOL_H
@@ -0,0 +1,141 @@
+/** \file localvol.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "localvol.h"
+
+namespace der
+{
+
+namespace
+{
+//! \brief Locates \p p_x on the increasing, non-uniform \p p_nodes.
+//! \return The index of the left node of the bracketing interval and the interpolation weight, flat outside the nodes.
+std::pair<size_t, double> locate(const std::vector<double> & p_nodes, double p_x)
+{
+    if (p_nodes.size() == 1 || p_x <= p_nodes.front())
+    {
+        return {0, 0.0};
+    }
+    if (p_x >= p_nodes.back())
+    {
+        return {p_nodes.size() - 2, 1.0};
+    }
+
+    size_t i = static_cast<size_t>(std::upper_bound(p_nodes.begin(), p_nodes.end(), p_x) - p_nodes.begin()) - 1;
+    return {i, (p_x - p_nodes[i]) / (p_nodes[i + 1] - p_nodes[i])};
+}
+
+//! \brief Validates the arbitrary grid of the resampling constructor, before any of it is read.
+//! \return The uniform grid spanning it, to resample onto, its vols zero.
+LocalVolSurface uniformGrid(const std::vector<double> & p_times, const std::vector<double> & p_logSpots,
+                            const std::vector<double> & p_vols, size_t p_nTimes, size_t p_nLogSpots)
+{
+    if (p_times.empty() || p_logSpots.size() < 2 || p_nTimes == 0 || p_nLogSpots < 2)
+    {
+        throw std::invalid_argument("LocalVolSurface: the grids need at least 1 time and 2 log-spot nodes.");
+    }
+    if (p_vols.size() != p_times.size() * p_logSpots.size())
+    {
+        throw std::invalid_argument("LocalVolSurface: the vols must be sampled on the full time x log-spot grid.");
+    }
+
+    // rejects NaNs too
+    auto increasing = [](const std::vector<double> & p_nodes) {
+        return std::adjacent_find(p_nodes.begin(), p_nodes.end(), [](double p_lhs, double p_rhs) { return !(p_lhs < p_rhs); })
+               == p_nodes.end();
+    };
+    if (!increasing(p_times) || !increasing(p_logSpots))
+    {
+        throw std::invalid_argument("LocalVolSurface: the time and log-spot nodes must be increasing.");
+    }
+
+    return LocalVolSurface(p_times.front(), p_nTimes > 1 ? (p_times.back() - p_times.front()) / (p_nTimes - 1) : 0.0, p_nTimes,
+                           p_logSpots.front(), (p_logSpots.back() - p_logSpots.front()) / (p_nLogSpots - 1), p_nLogSpots,
+                           std::vector<double>(p_nTimes * p_nLogSpots));
+}
+} // namespace
+
+LocalVolSurface::LocalVolSurface(double p_t0, double p_dt, size_t p_nTimes, double p_x0, double p_dx, size_t p_nLogSpots,
+                                 std::vector<double> p_vols)
+    : m_t0(p_t0)
+    , m_invDt(p_nTimes > 1 ? 1. / p_dt : 0.0)
+    , m_nTimes(p_nTimes)
+    , m_x0(p_x0)
+    , m_invDx(1. / p_dx)
+    , m_nLogSpots(p_nLogSpots)
+    , m_vols(std::move(p_vols))
+{
+    if (m_nTimes == 0 || m_nLogSpots < 2 || m_vols.size() != m_nTimes * m_nLogSpots)
+    {
+        throw std::invalid_argument("LocalVolSurface: the grid needs at least 1 time and 2 log-spot nodes, matching the vols.");
+    }
+    if ((m_nTimes > 1 && p_dt <= 0.0) || p_dx <= 0.0)
+    {
+        throw std::invalid_argument("LocalVolSurface: the grid steps must be positive.");
+    }
+}
+
+LocalVolSurface::LocalVolSurface(const std::vector<double> & p_times, const std::vector<double> & p_logSpots,
+                                 const std::vector<double> & p_vols, size_t p_nTimes, size_t p_nLogSpots)
+    : LocalVolSurface(uniformGrid(p_times, p_logSpots, p_vols, p_nTimes, p_nLogSpots))
+{
+    double dt = m_nTimes > 1 ? 1. / m_invDt : 0.0;
+    double dx = 1. / m_invDx;
+    size_t nX = p_logSpots.size();
+
+    // resample bilinearly onto the uniform grid; a one-off cost, hence the searching is fine here
+    for (size_t i = 0; i < m_nTimes; ++i)
+    {
+        auto [ti, wt] = locate(p_times, m_t0 + i * dt);
+        size_t ti1 = std::min(ti + 1, p_times.size() - 1);
+
+        for (size_t j = 0; j < m_nLogSpots; ++j)
+        {
+            auto [xj, wx] = locate(p_logSpots, m_x0 + j * dx);
+
+            double lower = (1 - wx) * p_vols[ti * nX + xj] + wx * p_vols[ti * nX + xj + 1];
+            double upper = (1 - wx) * p_vols[ti1 * nX + xj] + wx * p_vols[ti1 * nX + xj + 1];
+            m_vols[i * m_nLogSpots + j] = (1 - wt) * lower + wt * upper;
+        }
+    }
+}
+
+double LocalVolSurface::operator()(double p_t, double p_logSpot) const
+{
+    double u = std::min(std::max((p_t - m_t0) * m_invDt, 0.0), static_cast<double>(m_nTimes - 1));
+    size_t i = static_cast<size_t>(u);
+    size_t i1 = std::min(i + 1, m_nTimes - 1);
+    double w = u - i;
+
+    double lower = interpolate(m_vols.data() + i * m_nLogSpots, p_logSpot);
+    double upper = interpolate(m_vols.data() + i1 * m_nLogSpots, p_logSpot);
+
+    return lower + w * (upper - lower);
+}
+
+std::vector<double> LocalVolSurface::slice(double p_t, std::vector<double> && p_slice) const
+{
+    p_slice.resize(m_nLogSpots);
+
+    double u = std::min(std::max((p_t - m_t0) * m_invDt, 0.0), static_cast<double>(m_nTimes - 1));
+    size_t i = static_cast<size_t>(u);
+    size_t i1 = std::min(i + 1, m_nTimes - 1);
+    double w = u - i;
+
+    for (size_t j = 0; j < m_nLogSpots; ++j)
+    {
+        p_slice[j] = (1 - w) * m_vols[i * m_nLogSpots + j] + w * m_vols[i1 * m_nLogSpots + j];
+    }
+
+    return std::move(p_slice);
+}
+
+size_t LocalVolSurface::numLogSpots() const { return m_nLogSpots; }
+
+} // namespace der
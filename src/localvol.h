@@ -0,0 +1,90 @@
+/** \file localvol.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * A local volatility surface on a uniform (time x log-spot) grid.
+ */
+
+#ifndef LOCALVOL_H
+#define LOCALVOL_H
+
+#include <algorithm>
+#include <vector>
+
+namespace der
+{
+
+//! \brief A local volatility surface \f$\sigma(t, \log S)\f$ sampled on a uniform grid.
+//! Off the nodes the surface is interpolated bilinearly; outside of the grid it is extrapolated flat.
+//! Since the grid is uniform, locating a point is a multiplication and a truncation - no searching is involved.
+class LocalVolSurface
+{
+public:
+    //! \brief Constructor for a surface already sampled on a uniform grid.
+    //! \param p_t0 - The first time node.
+    //! \param p_dt - The time step.
+    //! \param p_nTimes - The number of time nodes.
+    //! \param p_x0 - The first log-spot node.
+    //! \param p_dx - The log-spot step.
+    //! \param p_nLogSpots - The number of log-spot nodes, at least 2.
+    //! \param p_vols - The volatilities, row-major: \p p_vols[i * p_nLogSpots + j] is \f$\sigma(t_i, x_j)\f$.
+    LocalVolSurface(double p_t0, double p_dt, size_t p_nTimes, double p_x0, double p_dx, size_t p_nLogSpots,
+                    std::vector<double> p_vols);
+
+    //! \brief Constructor for a surface sampled on an arbitrary rectangular grid, e.g. the output of a Dupire calibration.
+    //! The surface is resampled (bilinearly) onto a uniform grid of the requested resolution once, here.
+    //! Throws std::invalid_argument if either grid is too small, the vols do not match it or the nodes are not increasing.
+    //! \param p_times - The increasing time nodes.
+    //! \param p_logSpots - The increasing log-spot nodes.
+    //! \param p_vols - The volatilities, row-major in time.
+    //! \param p_nTimes - The number of uniform time nodes to resample to.
+    //! \param p_nLogSpots - The number of uniform log-spot nodes to resample to, at least 2.
+    LocalVolSurface(const std::vector<double> & p_times, const std::vector<double> & p_logSpots, const std::vector<double> & p_vols,
+                    size_t p_nTimes, size_t p_nLogSpots);
+
+    //! \brief The local volatility at time \p p_t and log-spot \p p_logSpot.
+    double operator()(double p_t, double p_logSpot) const;
+
+    //! \brief Interpolates the surface in time only.
+    //! \param p_t
+    //! \param p_slice - will be resized to \a numLogSpots.
+    //! \return \p p_slice holding the volatilities over the log-spot nodes at time \p p_t.
+    std::vector<double> slice(double p_t, std::vector<double> && p_slice) const;
+
+    //! \brief Linear interpolation in log-spot on a time slice, c.f. \a slice.
+    //! The hot path of local volatility engines: branch-free apart from the clamping.
+    //! \param p_slice - Pointer to the first of \a numLogSpots volatilities.
+    //! \param p_logSpot
+    double interpolate(const double * p_slice, double p_logSpot) const;
+
+    size_t numLogSpots() const;
+
+private:
+    double m_t0;
+    double m_invDt;
+    size_t m_nTimes;
+
+    double m_x0;
+    double m_invDx;
+    size_t m_nLogSpots;
+
+    std::vector<double> m_vols;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline double LocalVolSurface::interpolate(const double * p_slice, double p_logSpot) const
+{
+    // the clamping provides the flat extrapolation
+    double u = std::min(std::max((p_logSpot - m_x0) * m_invDx, 0.0), static_cast<double>(m_nLogSpots - 1));
+    size_t j = std::min(static_cast<size_t>(u), m_nLogSpots - 2);
+    double w = u - j;
+
+    return p_slice[j] + w * (p_slice[j + 1] - p_slice[j]);
+}
+
+} // namespace der
+
+#endif // LOCALVOL_H
@@ -0,0 +1,155 @@
+/** \file mappedfile.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mappedfile.h"
+
+namespace der
+{
+
+MappedFile::MappedFile(const std::string & p_path)
+{
+    int fd = ::open(p_path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        throw std::runtime_error("MappedFile: cannot open " + p_path + ": " + std::strerror(errno));
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) == -1)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("MappedFile: cannot stat " + p_path + ": " + std::strerror(error));
+    }
+    m_size = static_cast<size_t>(status.st_size);
+
+    // an empty file cannot be mapped - and there is nothing to map anyway
+    if (m_size > 0)
+    {
+        void * data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("MappedFile: cannot map " + p_path + ": " + std::strerror(error));
+        }
+        m_data = static_cast<const char *>(data);
+    }
+
+    // the mapping keeps the file referenced
+    ::close(fd);
+}
+
+MappedFile::MappedFile(MappedFile && p_other) noexcept
+    : m_data(std::exchange(p_other.m_data, nullptr)), m_size(std::exchange(p_other.m_size, 0))
+{}
+
+MappedFile & MappedFile::operator=(MappedFile && p_other) noexcept
+{
+    if (this != &p_other)
+    {
+        unmap();
+        m_data = std::exchange(p_other.m_data, nullptr);
+        m_size = std::exchange(p_other.m_size, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+const char * MappedFile::data() const { return m_data; }
+
+size_t MappedFile::size() const { return m_size; }
+
+void MappedFile::adviseSequential(size_t p_offset, size_t p_length) const
+{
+    if (m_data == nullptr)
+    {
+        return;
+    }
+
+    // madvise wants a page-aligned start
+    auto pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t start = p_offset - p_offset % pageSize;
+    ::madvise(const_cast<char *>(m_data) + start, std::min(p_length + (p_offset - start), m_size - start), MADV_SEQUENTIAL);
+}
+
+bool MappedFile::header(const char (&p_magic)[8], std::uint64_t p_version, Header & p_header) const
+{
+    if (m_size < sizeof(p_header))
+    {
+        return false;
+    }
+    std::memcpy(&p_header, m_data, sizeof(p_header));
+
+    return std::memcmp(p_header.magic, p_magic, sizeof(p_magic)) == 0 && p_header.version == p_version;
+}
+
+void MappedFile::write(const std::string & p_path, const char (&p_magic)[8], std::uint64_t p_version, std::uint64_t p_count,
+                       const std::function<void(std::ostream &)> & p_records)
+{
+    // unique per process, so that concurrent writers do not clobber each other; the rename is atomic
+    std::string tmpPath = p_path + ".tmp" + std::to_string(::getpid());
+
+    try
+    {
+        {
+            std::ofstream f{tmpPath, std::ios::binary | std::ios::trunc};
+            if (!f)
+            {
+                throw std::runtime_error("MappedFile: cannot write to " + tmpPath);
+            }
+
+            Header header{};
+            std::memcpy(header.magic, p_magic, sizeof(p_magic));
+            header.version = p_version;
+            header.count = p_count;
+            f.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            p_records(f);
+
+            if (!f.flush())
+            {
+                throw std::runtime_error("MappedFile: cannot write to " + tmpPath);
+            }
+        }
+
+        if (std::rename(tmpPath.c_str(), p_path.c_str()) != 0)
+        {
+            throw std::runtime_error("MappedFile: cannot write to " + p_path + ": " + std::strerror(errno));
+        }
+    }
+    catch (...)
+    {
+        // the stream is closed by now; no partial file is left behind
+        std::remove(tmpPath.c_str());
+        throw;
+    }
+}
+
+void MappedFile::unmap()
+{
+    if (m_data != nullptr)
+    {
+        ::munmap(const_cast<char *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+} // namespace der
@@ -0,0 +1,85 @@
+/** \file mappedfile.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Read-only memory-mapped files (POSIX) & the atomic writing of the files to be mapped.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace der
+{
+
+//! \brief A whole file mapped read-only into memory.
+//! The pages are loaded lazily by the OS & shared between the processes mapping the same file, so large files cost nothing up
+//! front. Movable, not copyable; share it, e.g. through a std::shared_ptr, to read it from several places.
+class MappedFile
+{
+public:
+    //! \brief The header of the files written to be mapped, c.f. \a write: the format's magic & version, followed by \p count
+    //! records. Its size keeps the records cache-line aligned in the mapping.
+    struct Header
+    {
+        char magic[8];
+        std::uint64_t version;
+        std::uint64_t count;
+        std::uint64_t reserved[5];
+    };
+
+    //! \brief Maps the file @ \p p_path. Throws std::runtime_error if it cannot be opened or mapped.
+    //! \param p_path
+    explicit MappedFile(const std::string & p_path);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile && p_other) noexcept;
+    MappedFile & operator=(MappedFile && p_other) noexcept;
+    ~MappedFile();
+
+    //! \brief The start of the mapping, page-aligned.
+    const char * data() const;
+    //! \brief The size of the file, in bytes.
+    size_t size() const;
+
+    //! \brief Advises the OS that the range will be read sequentially, e.g. to read ahead aggressively.
+    //! \param p_offset
+    //! \param p_length
+    void adviseSequential(size_t p_offset, size_t p_length) const;
+
+    //! \brief Reads the \a Header @ the start of the file.
+    //! \param p_magic
+    //! \param p_version
+    //! \param p_header
+    //! \return false if the file is shorter than a header or of another format or version.
+    bool header(const char (&p_magic)[8], std::uint64_t p_version, Header & p_header) const;
+
+    //! \brief Writes a file atomically, via a temporary file in the same directory renamed over \p p_path: the processes mapping
+    //! the previous one keep it. The temporary file is removed whatever fails, \p p_records included.
+    //! Throws std::runtime_error if the file cannot be written.
+    //! \param p_path
+    //! \param p_magic - c.f. \a Header.
+    //! \param p_version
+    //! \param p_count - The number of records.
+    //! \param p_records - Writes whatever follows the header.
+    static void write(const std::string & p_path, const char (&p_magic)[8], std::uint64_t p_version, std::uint64_t p_count,
+                      const std::function<void(std::ostream &)> & p_records);
+
+private:
+    void unmap();
+
+    const char * m_data{nullptr};
+    size_t m_size{0};
+};
+
+static_assert(sizeof(MappedFile::Header) == 64, "MappedFile::Header: the records are to stay aligned.");
+
+} // namespace der
+
+#endif // MAPPEDFILE_H
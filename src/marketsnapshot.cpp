@@ -0,0 +1,144 @@
+/** \file marketsnapshot.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "marketsnapshot.h"
+
+namespace der
+{
+
+namespace
+{
+
+constexpr std::uint32_t s_piecewiseConstant = 0;
+constexpr std::uint32_t s_piecewiseLinear = 1;
+
+//! \brief The number of the arrays of a curve.
+constexpr size_t s_nArrays = 4;
+
+} // namespace
+
+MarketSnapshot::MarketSnapshot(const std::string & p_path) : m_file(std::make_shared<const MappedFile>(p_path))
+{
+    MappedFile::Header header;
+    if (!m_file->header(s_magic, s_version, header)
+        || header.count > (m_file->size() - sizeof(header)) / sizeof(MarketSnapshotEntry))
+    {
+        throw std::runtime_error("MarketSnapshot: " + p_path + " is not a market snapshot.");
+    }
+
+    // the mapping is page-aligned, the header & the entries are 64 bytes, so the entries & the doubles are properly aligned
+    m_entries = reinterpret_cast<const MarketSnapshotEntry *>(m_file->data() + sizeof(header));
+    m_count = header.count;
+
+    // the directory only: the curves' pages are left to be loaded on first use
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        const MarketSnapshotEntry & entry = m_entries[i];
+        size_t bytes = s_nArrays * sizeof(double);
+
+        if (std::memchr(entry.name, '\0', sizeof(entry.name)) == nullptr
+            || (entry.kind != s_piecewiseConstant && entry.kind != s_piecewiseLinear) || entry.size == 0
+            || entry.offset % sizeof(double) != 0 || entry.offset > m_file->size()
+            || entry.size > (m_file->size() - entry.offset) / bytes)
+        {
+            throw std::runtime_error("MarketSnapshot: " + p_path + " has a corrupt entry.");
+        }
+    }
+}
+
+Parameters MarketSnapshot::curve(const std::string & p_name) const
+{
+    const MarketSnapshotEntry * entry = std::find_if(m_entries, m_entries + m_count, [&](const MarketSnapshotEntry & p_entry) {
+        return p_name == p_entry.name;
+    });
+    if (entry == m_entries + m_count)
+    {
+        throw std::out_of_range("MarketSnapshot: no curve named " + p_name + ".");
+    }
+
+    const double * first = reinterpret_cast<const double *>(m_file->data() + entry->offset);
+    size_t n = entry->size;
+    ParametersPiecewise::Arrays arrays{Span<const double>(first, n), Span<const double>(first + n, n),
+                                       Span<const double>(first + 2 * n, n), Span<const double>(first + 3 * n, n), m_file};
+
+    if (entry->kind == s_piecewiseConstant)
+    {
+        return ParametersPiecewiseConstant(std::move(arrays));
+    }
+    return ParametersPiecewiseLinear(std::move(arrays));
+}
+
+std::vector<std::string> MarketSnapshot::names() const
+{
+    std::vector<std::string> ret;
+    ret.reserve(m_count);
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        ret.emplace_back(m_entries[i].name);
+    }
+    return ret;
+}
+
+size_t MarketSnapshot::size() const { return m_count; }
+
+// MarketSnapshot::Writer
+
+void MarketSnapshot::Writer::add(const std::string & p_name, const ParametersPiecewiseConstant & p_curve)
+{
+    add(p_name, s_piecewiseConstant, p_curve);
+}
+
+void MarketSnapshot::Writer::add(const std::string & p_name, const ParametersPiecewiseLinear & p_curve)
+{
+    add(p_name, s_piecewiseLinear, p_curve);
+}
+
+void MarketSnapshot::Writer::add(const std::string & p_name, std::uint32_t p_kind, const ParametersPiecewise & p_curve)
+{
+    if (p_name.empty() || p_name.size() >= sizeof(MarketSnapshotEntry::name))
+    {
+        throw std::invalid_argument("MarketSnapshot::Writer: the name " + p_name + " is empty or too long.");
+    }
+    if (std::any_of(m_curves.begin(), m_curves.end(), [&](const Curve & p_other) { return p_other.name == p_name; }))
+    {
+        throw std::invalid_argument("MarketSnapshot::Writer: the name " + p_name + " is taken.");
+    }
+
+    // shares the curve's arrays, nothing is copied until written
+    m_curves.push_back({p_name, p_kind, p_curve.arrays()});
+}
+
+void MarketSnapshot::Writer::write(const std::string & p_path) const
+{
+    MappedFile::write(p_path, s_magic, s_version, m_curves.size(), [this](std::ostream & p_out) {
+        std::uint64_t offset = sizeof(MappedFile::Header) + m_curves.size() * sizeof(MarketSnapshotEntry);
+        for (const Curve & curve : m_curves)
+        {
+            MarketSnapshotEntry entry{};
+            std::memcpy(entry.name, curve.name.data(), curve.name.size());
+            entry.kind = curve.kind;
+            entry.size = curve.arrays.times.size();
+            entry.offset = offset;
+            p_out.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+
+            offset += s_nArrays * entry.size * sizeof(double);
+        }
+
+        for (const Curve & curve : m_curves)
+        {
+            for (Span<const double> array : {curve.arrays.times, curve.arrays.values, curve.arrays.integrals, curve.arrays.integralsSquare})
+            {
+                p_out.write(reinterpret_cast<const char *>(array.data()), static_cast<std::streamsize>(array.size() * sizeof(double)));
+            }
+        }
+    });
+}
+
+} // namespace der
@@ -0,0 +1,101 @@
+/** \file marketsnapshot.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Market data term structures in a memory-mapped binary file.
+ */
+
+#ifndef MARKETSNAPSHOT_H
+#define MARKETSNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mappedfile.h"
+#include "parameters.h"
+
+namespace der
+{
+
+//! \brief The directory entry of a curve: its arrays, c.f. \a ParametersPiecewise::Arrays, are \p size native-endian doubles
+//! each, the times, values, integrals & integrals of the square following each other @ \p offset from the start of the file.
+struct MarketSnapshotEntry
+{
+    //! \brief NUL-terminated.
+    char name[40];
+    //! \brief 0 for \a ParametersPiecewiseConstant, 1 for \a ParametersPiecewiseLinear.
+    std::uint32_t kind;
+    std::uint32_t reserved;
+    std::uint64_t size;
+    std::uint64_t offset;
+};
+
+static_assert(sizeof(MarketSnapshotEntry) == 64, "MarketSnapshotEntry: the arrays are to stay aligned.");
+
+//! \brief A snapshot of market data, e.g. rate, dividend & volatility curves, as named piecewise term structures.
+//! The file is a \a MappedFile::Header followed by its \p count \a MarketSnapshotEntry's, then by the curves' arrays.
+//! The file is memory-mapped, rather than read: opening it validates the directory only, & the curves are views of the mapping,
+//! their integrals precomputed by the \a Writer - nothing is parsed, copied nor recomputed. Processes opening the same snapshot
+//! share its pages in the page cache.
+//! Copies share the mapping, which the curves keep alive.
+class MarketSnapshot
+{
+public:
+    //! \brief Maps the snapshot @ \p p_path. Throws std::runtime_error if it cannot be mapped or is not a valid snapshot.
+    //! \param p_path
+    explicit MarketSnapshot(const std::string & p_path);
+
+    //! \brief The curve named \p p_name, viewing the mapping. Throws std::out_of_range if there is none.
+    //! \param p_name
+    //! \return
+    Parameters curve(const std::string & p_name) const;
+
+    //! \brief The names of the curves, in the order of the file.
+    std::vector<std::string> names() const;
+    //! \brief The number of the curves.
+    size_t size() const;
+
+    //! \brief Collects curves & writes them out as a snapshot.
+    class Writer
+    {
+    public:
+        //! \brief Adds a curve. Throws std::invalid_argument if the name is empty, too long, i.e. of 40 characters or more, or taken.
+        //! \param p_name
+        //! \param p_curve
+        void add(const std::string & p_name, const ParametersPiecewiseConstant & p_curve);
+        //! \brief Overload for piecewise-linear curves.
+        void add(const std::string & p_name, const ParametersPiecewiseLinear & p_curve);
+
+        //! \brief Writes the snapshot to \p p_path, atomically, via a temporary file in the same directory: the processes mapping
+        //! the previous one keep it. Throws std::runtime_error if it cannot be written.
+        //! \param p_path
+        void write(const std::string & p_path) const;
+
+    private:
+        void add(const std::string & p_name, std::uint32_t p_kind, const ParametersPiecewise & p_curve);
+
+        struct Curve
+        {
+            std::string name;
+            std::uint32_t kind;
+            ParametersPiecewise::Arrays arrays;
+        };
+
+        std::vector<Curve> m_curves;
+    };
+
+private:
+    static constexpr char s_magic[8] = {'D', 'E', 'R', 'M', 'A', 'R', 'K', 'T'};
+    static constexpr std::uint64_t s_version = 1;
+
+    std::shared_ptr<const MappedFile> m_file;
+    const MarketSnapshotEntry * m_entries{nullptr};
+    size_t m_count{0};
+};
+
+} // namespace der
+
+#endif // MARKETSNAPSHOT_H
@@ -0,0 +1,78 @@
+/** \file parallel.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Sharing independent tasks out among threads.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace der
+{
+
+//! \brief Runs \p p_task on each of the indices [0, \p p_nTasks), on up to \p p_nThreads threads, the calling one included.
+//! The tasks are picked up one at a time, so uneven workloads balance out. A thread whose task throws takes no further ones; the
+//! exception is rethrown once all the threads are done, the lowest thread's if several threw.
+//! \param p_nTasks
+//! \param p_nThreads - No more threads than tasks are started.
+//! \param p_task - Called with the index of the task, from several threads @ once.
+template <typename Task>
+void parallelFor(size_t p_nTasks, size_t p_nThreads, const Task & p_task);
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Task>
+void parallelFor(size_t p_nTasks, size_t p_nThreads, const Task & p_task)
+{
+    std::atomic<size_t> next{0};
+    // one slot per thread, so that the threads never share one
+    std::vector<std::exception_ptr> errors(std::max(std::min(p_nThreads, p_nTasks), size_t{1}));
+
+    auto worker = [&](size_t p_thread) {
+        try
+        {
+            for (size_t i = next++; i < p_nTasks; i = next++)
+            {
+                p_task(i);
+            }
+        }
+        catch (...)
+        {
+            errors[p_thread] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < errors.size(); ++t)
+    {
+        threads.emplace_back(worker, t);
+    }
+    worker(0);
+
+    for (auto & thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto & error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace der
+
+#endif // PARALLEL_H
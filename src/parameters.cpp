@@ -5,8 +5,14 @@
 
 #include "parameters.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace der
 {
@@ -15,44 +21,108 @@ namespace der
 
 ParametersInner::~ParametersInner() = default;
 
+ParametersInner * ParametersInner::cloneInto(void * /*p_buffer*/, size_t /*p_capacity*/) const { return nullptr; }
+
+std::optional<double> ParametersInner::constant() const { return std::nullopt; }
+
 // Parameters
 
-Parameters::Parameters(const ParametersInner & parameter) : m_pImpl(parameter.clone()) {}
+Parameters::Parameters(const ParametersInner & parameter) { assign(parameter); }
 
-Parameters::~Parameters() = default;
+Parameters::~Parameters() { reset(); }
 
-Parameters::Parameters(const Parameters & other) : m_pImpl(other.m_pImpl->clone()) {}
+Parameters::Parameters(const Parameters & other)
+{
+    if (other.m_pImpl)
+    {
+        assign(*other.m_pImpl);
+    }
+}
 
-Parameters::Parameters(Parameters && other) noexcept = default;
+Parameters::Parameters(Parameters && other) noexcept { take(other); }
 
 Parameters & Parameters::operator=(const Parameters & other)
 {
     if (this != &other)
     {
-        m_pImpl = other.m_pImpl->clone();
+        // copied first, so that a throwing clone leaves this intact
+        Parameters copy(other);
+        reset();
+        take(copy);
     }
 
     return *this;
 }
 
-double Parameters::integral(double time1, double time2) const { return m_pImpl->integral(time1, time2); }
+Parameters & Parameters::operator=(Parameters && other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        take(other);
+    }
 
-double Parameters::integralSquare(double time1, double time2) const { return m_pImpl->integralSquare(time1, time2); }
+    return *this;
+}
+
+double Parameters::mean(double time1, double time2) const { return integral(time1, time2) / (time2 - time1); }
 
-double Parameters::mean(double time1, double time2) const { return m_pImpl->integral(time1, time2) / (time2 - time1); }
+double Parameters::RMS(double time1, double time2) const { return std::sqrt(integralSquare(time1, time2) / (time2 - time1)); }
+
+void Parameters::assign(const ParametersInner & p_inner)
+{
+    m_pImpl = p_inner.cloneInto(m_buffer, s_bufferSize);
+    m_inline = m_pImpl != nullptr;
+    if (!m_inline)
+    {
+        m_pImpl = p_inner.clone().release();
+    }
+
+    std::optional<double> constant = m_pImpl->constant();
+    m_isConstant = constant.has_value();
+    m_constant = constant.value_or(0.0);
+}
 
-double Parameters::RMS(double time1, double time2) const
+void Parameters::take(Parameters & other) noexcept
 {
-    return std::sqrt(m_pImpl->integralSquare(time1, time2) / (time2 - time1));
+    if (other.m_inline)
+    {
+        // cannot throw: only the implementations with a noexcept copy are inline
+        m_pImpl = other.m_pImpl->cloneInto(m_buffer, s_bufferSize);
+        m_inline = true;
+        other.reset();
+    }
+    else
+    {
+        m_pImpl = other.m_pImpl;
+        m_inline = false;
+        other.m_pImpl = nullptr;
+    }
+
+    m_isConstant = other.m_isConstant;
+    m_constant = other.m_constant;
 }
 
-Parameters & Parameters::operator=(Parameters && other) noexcept = default;
+void Parameters::reset() noexcept
+{
+    if (m_inline)
+    {
+        m_pImpl->~ParametersInner();
+    }
+    else
+    {
+        delete m_pImpl;
+    }
+
+    m_pImpl = nullptr;
+    m_inline = false;
+}
 
 // ParametersConstant
 
 ParametersConstant::ParametersConstant(double constant) : m_constant(constant) {}
 
-ParametersConstant::~ParametersConstant() { delete m_strRepr; }
+ParametersConstant::~ParametersConstant() = default;
 
 ParametersConstant::ParametersConstant(std::string p_str) : ParametersConstant(p_str.data()) {}
 
@@ -64,11 +134,7 @@ der::ParametersConstant::operator double() const { return const_cast<ParametersC
 
 der::ParametersConstant::operator const char *()
 {
-    if(m_strRepr == nullptr)
-    {
-        m_strRepr = new char[16];
-    }
-    std::snprintf(m_strRepr, 16, "%g", m_constant);
+    std::snprintf(m_strRepr, sizeof(m_strRepr), "%g", m_constant);
     return m_strRepr;
 }
 
@@ -80,8 +146,263 @@ der::ParametersConstant::operator std::string() const { return const_cast<Parame
 
 std::unique_ptr<ParametersInner> ParametersConstant::clone() const { return std::make_unique<ParametersConstant>(m_constant); }
 
+ParametersInner * ParametersConstant::cloneInto(void * p_buffer, size_t p_capacity) const
+{
+    return ParametersInner::cloneInto(*this, p_buffer, p_capacity);
+}
+
+std::optional<double> ParametersConstant::constant() const { return m_constant; }
+
 double ParametersConstant::integral(double time1, double time2) const { return m_constant * (time2 - time1); }
 
 double ParametersConstant::integralSquare(double time1, double time2) const { return m_constant * m_constant * (time2 - time1); }
 
+// ParametersShifted
+
+ParametersShifted::ParametersShifted(Parameters p_base, double p_shift) : m_base(std::move(p_base)), m_shift(p_shift) {}
+
+std::unique_ptr<ParametersInner> ParametersShifted::clone() const { return std::make_unique<ParametersShifted>(*this); }
+
+double ParametersShifted::integral(double time1, double time2) const
+{
+    return m_base.integral(time1, time2) + m_shift * (time2 - time1);
+}
+
+double ParametersShifted::integralSquare(double time1, double time2) const
+{
+    // (f + s)^2 = f^2 + 2 s f + s^2
+    return m_base.integralSquare(time1, time2) + 2.0 * m_shift * m_base.integral(time1, time2)
+           + m_shift * m_shift * (time2 - time1);
+}
+
+// ParametersPiecewise
+
+ParametersPiecewise::ParametersPiecewise(std::vector<double> p_times, std::vector<double> p_values, Integrator p_integrator)
+{
+    if (p_times.empty() || p_times.size() != p_values.size())
+    {
+        throw std::invalid_argument("ParametersPiecewise: one time per value is required.");
+    }
+    if (std::adjacent_find(p_times.begin(), p_times.end(), std::greater_equal<double>()) != p_times.end())
+    {
+        throw std::invalid_argument("ParametersPiecewise: the times are to be increasing.");
+    }
+
+    // a single allocation, laid out as the arrays follow each other
+    size_t n = p_times.size();
+    auto storage = std::make_shared<std::vector<double>>(4 * n);
+    std::copy(p_times.begin(), p_times.end(), storage->begin());
+    std::copy(p_values.begin(), p_values.end(), storage->begin() + static_cast<std::ptrdiff_t>(n));
+
+    Span<double> all(*storage);
+    p_integrator(all.subspan(0, n), all.subspan(n, n), all.subspan(2 * n, n), all.subspan(3 * n, n));
+
+    m_data = std::make_shared<const Arrays>(
+        Arrays{all.subspan(0, n), all.subspan(n, n), all.subspan(2 * n, n), all.subspan(3 * n, n), std::move(storage)});
+}
+
+ParametersPiecewise::ParametersPiecewise(Arrays p_arrays)
+{
+    size_t n = p_arrays.times.size();
+    if (n == 0 || p_arrays.values.size() != n || p_arrays.integrals.size() != n || p_arrays.integralsSquare.size() != n)
+    {
+        throw std::invalid_argument("ParametersPiecewise: the arrays are to be of the same, non-zero, size.");
+    }
+
+    m_data = std::make_shared<const Arrays>(std::move(p_arrays));
+}
+
+ParametersPiecewise::ParametersPiecewise(const ParametersPiecewise & other) noexcept
+    : ParametersInner(other), m_data(other.m_data), m_cursor(other.m_cursor.load(std::memory_order_relaxed))
+{}
+
+ParametersPiecewise & ParametersPiecewise::operator=(const ParametersPiecewise & other) noexcept
+{
+    m_data = other.m_data;
+    m_cursor.store(other.m_cursor.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    return *this;
+}
+
+Span<const double> ParametersPiecewise::times() const { return m_data->times; }
+
+Span<const double> ParametersPiecewise::values() const { return m_data->values; }
+
+const ParametersPiecewise::Arrays & ParametersPiecewise::arrays() const { return *m_data; }
+
+size_t ParametersPiecewise::searches() const { return m_searches.load(std::memory_order_relaxed); }
+
+size_t ParametersPiecewise::locate(double p_time) const
+{
+    Span<const double> times = m_data->times;
+    size_t n = times.size();
+
+    auto isAt = [&](size_t p_cursor) {
+        return (p_cursor == 0 || times[p_cursor - 1] < p_time) && (p_cursor == n || p_time <= times[p_cursor]);
+    };
+
+    size_t cursor = m_cursor.load(std::memory_order_relaxed);
+    if (isAt(cursor))
+    {
+        return cursor;
+    }
+
+    if (cursor < n && isAt(cursor + 1))
+    {
+        ++cursor;
+    }
+    else
+    {
+        cursor = static_cast<size_t>(std::lower_bound(times.begin(), times.end(), p_time) - times.begin());
+        m_searches.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_cursor.store(cursor, std::memory_order_relaxed);
+
+    return cursor;
+}
+
+// ParametersPiecewiseConstant
+
+ParametersPiecewiseConstant::ParametersPiecewiseConstant(std::vector<double> p_times, std::vector<double> p_values)
+    : ParametersPiecewise(std::move(p_times), std::move(p_values), integrate)
+{
+    if (times()[0] <= 0.0)
+    {
+        throw std::invalid_argument("ParametersPiecewiseConstant: the times are to be positive.");
+    }
+}
+
+ParametersPiecewiseConstant::ParametersPiecewiseConstant(Arrays p_arrays) : ParametersPiecewise(std::move(p_arrays)) {}
+
+void ParametersPiecewiseConstant::integrate(Span<const double> p_times, Span<const double> p_values, Span<double> p_integrals,
+                                            Span<double> p_integralsSquare)
+{
+    double start = 0.0;
+    double integral = 0.0;
+    double integralSquare = 0.0;
+
+    for (size_t i = 0; i < p_times.size(); ++i)
+    {
+        integral += p_values[i] * (p_times[i] - start);
+        integralSquare += p_values[i] * p_values[i] * (p_times[i] - start);
+        p_integrals[i] = integral;
+        p_integralsSquare[i] = integralSquare;
+        start = p_times[i];
+    }
+}
+
+std::unique_ptr<ParametersInner> ParametersPiecewiseConstant::clone() const
+{
+    return std::make_unique<ParametersPiecewiseConstant>(*this);
+}
+
+ParametersInner * ParametersPiecewiseConstant::cloneInto(void * p_buffer, size_t p_capacity) const
+{
+    return ParametersInner::cloneInto(*this, p_buffer, p_capacity);
+}
+
+double ParametersPiecewiseConstant::integral(double time1, double time2) const
+{
+    // the start first: the cursor is then left on the end's piece, where the next of consecutive queries starts
+    double start = integralFromZero(time1, false);
+    return integralFromZero(time2, false) - start;
+}
+
+double ParametersPiecewiseConstant::integralSquare(double time1, double time2) const
+{
+    double start = integralFromZero(time1, true);
+    return integralFromZero(time2, true) - start;
+}
+
+double ParametersPiecewiseConstant::integralFromZero(double p_time, bool p_square) const
+{
+    const Arrays & data = arrays();
+
+    // the first & last pieces extend beyond their ends
+    size_t piece = std::min(locate(p_time), data.times.size() - 1);
+    double start = piece > 0 ? data.times[piece - 1] : 0.0;
+    double value = p_square ? data.values[piece] * data.values[piece] : data.values[piece];
+
+    if (piece == 0)
+    {
+        return value * p_time;
+    }
+    return (p_square ? data.integralsSquare[piece - 1] : data.integrals[piece - 1]) + value * (p_time - start);
+}
+
+// ParametersPiecewiseLinear
+
+ParametersPiecewiseLinear::ParametersPiecewiseLinear(std::vector<double> p_times, std::vector<double> p_values)
+    : ParametersPiecewise(std::move(p_times), std::move(p_values), integrate)
+{}
+
+ParametersPiecewiseLinear::ParametersPiecewiseLinear(Arrays p_arrays) : ParametersPiecewise(std::move(p_arrays)) {}
+
+void ParametersPiecewiseLinear::integrate(Span<const double> p_times, Span<const double> p_values, Span<double> p_integrals,
+                                          Span<double> p_integralsSquare)
+{
+    p_integrals[0] = 0.0;
+    p_integralsSquare[0] = 0.0;
+
+    for (size_t i = 1; i < p_times.size(); ++i)
+    {
+        double dt = p_times[i] - p_times[i - 1];
+        double y0 = p_values[i - 1];
+        double y1 = p_values[i];
+
+        p_integrals[i] = p_integrals[i - 1] + 0.5 * (y0 + y1) * dt;
+        p_integralsSquare[i] = p_integralsSquare[i - 1] + (y0 * y0 + y0 * y1 + y1 * y1) * dt / 3.0;
+    }
+}
+
+std::unique_ptr<ParametersInner> ParametersPiecewiseLinear::clone() const
+{
+    return std::make_unique<ParametersPiecewiseLinear>(*this);
+}
+
+ParametersInner * ParametersPiecewiseLinear::cloneInto(void * p_buffer, size_t p_capacity) const
+{
+    return ParametersInner::cloneInto(*this, p_buffer, p_capacity);
+}
+
+double ParametersPiecewiseLinear::integral(double time1, double time2) const
+{
+    // the start first, c.f. ParametersPiecewiseConstant::integral
+    double start = integralFromFirst(time1, false);
+    return integralFromFirst(time2, false) - start;
+}
+
+double ParametersPiecewiseLinear::integralSquare(double time1, double time2) const
+{
+    double start = integralFromFirst(time1, true);
+    return integralFromFirst(time2, true) - start;
+}
+
+double ParametersPiecewiseLinear::integralFromFirst(double p_time, bool p_square) const
+{
+    const Arrays & data = arrays();
+    size_t n = data.times.size();
+    size_t node = locate(p_time);
+
+    // flat beyond the ends
+    if (node == 0 || node == n)
+    {
+        size_t end = node == 0 ? 0 : n - 1;
+        double value = p_square ? data.values[end] * data.values[end] : data.values[end];
+        return (p_square ? data.integralsSquare[end] : data.integrals[end]) + value * (p_time - data.times[end]);
+    }
+
+    // within [t_{k}, t_{k + 1}): f = y_k + m u, u = t - t_k
+    size_t k = node - 1;
+    double y = data.values[k];
+    double slope = (data.values[k + 1] - y) / (data.times[k + 1] - data.times[k]);
+    double u = p_time - data.times[k];
+
+    if (p_square)
+    {
+        return data.integralsSquare[k] + u * (y * y + u * (y * slope + u * slope * slope / 3.0));
+    }
+    return data.integrals[k] + u * (y + 0.5 * u * slope);
+}
+
 } // namespace der
@@ -8,7 +8,15 @@
 #ifndef PARAMETERS_H
 #define PARAMETERS_H
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "span.h"
 
 namespace der
 {
@@ -29,6 +37,14 @@ public:
     //! \brief clone
     //! \return
     virtual std::unique_ptr<ParametersInner> clone() const = 0;
+    //! \brief clones into the caller's storage, c.f. \a Parameters
+    //! \param p_buffer - aligned to std::max_align_t
+    //! \param p_capacity - its size
+    //! \return the clone, or nullptr if it does not fit: the default
+    virtual ParametersInner * cloneInto(void * p_buffer, size_t p_capacity) const;
+    //! \brief the value, if constant: for the callers' closed forms. The default is none.
+    //! \return
+    virtual std::optional<double> constant() const;
     //! \brief a definite integral
     //! \param time1
     //! \param time2
@@ -39,13 +55,24 @@ public:
     //! \param time2
     //! \return
     virtual double integralSquare(double time1, double time2) const = 0;
+
+protected:
+    //! \brief \a cloneInto for \p Derived: in place if it fits & its copy cannot throw, so that moving the clone stays noexcept.
+    template <typename Derived>
+    static ParametersInner * cloneInto(const Derived & p_this, void * p_buffer, size_t p_capacity);
 };
 
 //! \brief The PIPML interface class
+//! Small implementations, e.g. \a ParametersConstant or the piecewise ones, are stored inline rather than on the heap, so that
+//! copying, e.g. on an engine's construction, does not allocate. The constant ones are recognized & integrated in closed form,
+//! without the virtual dispatch.
 class Parameters
 {
 
 public:
+    //! \brief The size of the inline storage.
+    static constexpr size_t s_bufferSize = 6 * sizeof(void *);
+
     Parameters() = default;
     Parameters(const ParametersInner & parameter);
 
@@ -78,7 +105,21 @@ public:
     double RMS(double time1, double time2) const;
 
 private:
-    std::unique_ptr<ParametersInner> m_pImpl{nullptr};
+    //! \brief Clones \p p_inner, inline if it fits.
+    void assign(const ParametersInner & p_inner);
+    //! \brief Takes over \p other's implementation, stealing it if on the heap.
+    void take(Parameters & other) noexcept;
+    //! \brief Destroys the implementation.
+    void reset() noexcept;
+
+    alignas(std::max_align_t) unsigned char m_buffer[s_bufferSize];
+    //! \brief In \a m_buffer if \a m_inline, on the heap otherwise.
+    ParametersInner * m_pImpl{nullptr};
+    bool m_inline{false};
+
+    //! \brief The value of a constant implementation, c.f. \a ParametersInner::constant.
+    bool m_isConstant{false};
+    double m_constant{0.0};
 };
 
 //! \brief A constant-type implementation
@@ -119,6 +160,8 @@ public:
     //!@}
 
     std::unique_ptr<ParametersInner> clone() const override;
+    ParametersInner * cloneInto(void * p_buffer, size_t p_capacity) const override;
+    std::optional<double> constant() const override;
     double integral(double time1, double time2) const override;
     double integralSquare(double time1, double time2) const override;
 
@@ -126,9 +169,169 @@ private:
     double m_constant{0.0};
 
     //! \brief To enable implicit conversions, e.g. for printing
-    char * m_strRepr{nullptr};
+    char m_strRepr[16]{};
+};
+
+//! \brief A parallel shift of another parameter, e.g. for bump & revalue scenarios.
+class ParametersShifted : public ParametersInner
+{
+
+public:
+    //! \brief ParametersShifted
+    //! \param p_base - The parameter being shifted.
+    //! \param p_shift - The shift, added to the parameter at all times.
+    ParametersShifted(Parameters p_base, double p_shift);
+
+    std::unique_ptr<ParametersInner> clone() const override;
+    double integral(double time1, double time2) const override;
+    double integralSquare(double time1, double time2) const override;
+
+private:
+    Parameters m_base;
+    double m_shift{0.0};
+};
+
+//! \brief The common base of the piecewise term structures: values @ increasing times, & the integrals of the function & of its square
+//! from the first piece's start up to each time, precomputed. An integral is then a lookup & the integral over a part of a piece.
+//! The lookup is O(log n), but the piece of the previous query & its successor are tried first, so that the monotone sequences of
+//! queries of the engines, e.g. over consecutive dates, cost O(1).
+//! The data are immutable & shared among the clones: cloning, e.g. per engine or path generator, does not copy them. They are
+//! either owned or views of arrays kept elsewhere, e.g. in a memory-mapped \a MarketSnapshot.
+class ParametersPiecewise : public ParametersInner
+{
+
+public:
+    //! \brief The arrays of a term structure, of the same size.
+    struct Arrays
+    {
+        Span<const double> times;
+        Span<const double> values;
+        //! \brief \f$\int f\f$ up to each time
+        Span<const double> integrals;
+        //! \brief \f$\int f^2\f$ up to each time
+        Span<const double> integralsSquare;
+        //! \brief Keeps the arrays alive, e.g. the owned vector or the mapped file.
+        std::shared_ptr<const void> storage;
+    };
+
+    ParametersPiecewise(const ParametersPiecewise & other) noexcept;
+    ParametersPiecewise & operator=(const ParametersPiecewise & other) noexcept;
+
+    Span<const double> times() const;
+    Span<const double> values() const;
+    //! \brief All the arrays, e.g. to be stored & viewed later, c.f. the view constructors.
+    const Arrays & arrays() const;
+    //! \brief The number of the lookups that missed the hint & fell back to a binary search, e.g. to check that a sequence of
+    //! queries is served in O(1). Copies start from their own count.
+    size_t searches() const;
+
+protected:
+    //! \brief Computes the integrals up to each time, into the last two arrays.
+    using Integrator = void (*)(Span<const double> p_times, Span<const double> p_values, Span<double> p_integrals,
+                                Span<double> p_integralsSquare);
+
+    //! \brief Owning constructor. Throws std::invalid_argument unless the times are increasing, one per value.
+    //! \param p_times
+    //! \param p_values
+    //! \param p_integrator
+    ParametersPiecewise(std::vector<double> p_times, std::vector<double> p_values, Integrator p_integrator);
+    //! \brief View constructor. Throws std::invalid_argument unless the arrays are of the same, non-zero, size.
+    //! \param p_arrays
+    explicit ParametersPiecewise(Arrays p_arrays);
+
+    //! \brief The number of the times strictly before \p p_time, in [0, n].
+    //! \param p_time
+    //! \return
+    size_t locate(double p_time) const;
+
+private:
+    std::shared_ptr<const Arrays> m_data;
+    //! \brief The last result of \a locate. A hint only: relaxed, since the clones may be shared across threads.
+    mutable std::atomic<size_t> m_cursor{0};
+    mutable std::atomic<size_t> m_searches{0};
 };
 
+//! \brief A piecewise-constant term structure, e.g. forward volatilities bootstrapped from option expiries.
+//! The i-th value holds on \f$(t_{i - 1}, t_i]\f$, \f$t_{-1} = 0\f$; the first one is extended before 0, the last one beyond the
+//! last time.
+class ParametersPiecewiseConstant : public ParametersPiecewise
+{
+
+public:
+    //! \brief Constructor. Throws std::invalid_argument unless the times are positive & increasing, one per value.
+    //! \param p_times - The right ends of the pieces.
+    //! \param p_values
+    ParametersPiecewiseConstant(std::vector<double> p_times, std::vector<double> p_values);
+    //! \brief A view of the \a arrays of another, nothing copied nor recomputed, so trusted as they are.
+    //! \param p_arrays
+    explicit ParametersPiecewiseConstant(Arrays p_arrays);
+
+    std::unique_ptr<ParametersInner> clone() const override;
+    ParametersInner * cloneInto(void * p_buffer, size_t p_capacity) const override;
+    double integral(double time1, double time2) const override;
+    double integralSquare(double time1, double time2) const override;
+
+private:
+    static void integrate(Span<const double> p_times, Span<const double> p_values, Span<double> p_integrals,
+                          Span<double> p_integralsSquare);
+
+    //! \brief \f$\int_0^t f\f$, or of \f$f^2\f$ if \p p_square.
+    double integralFromZero(double p_time, bool p_square) const;
+};
+
+//! \brief A piecewise-linear term structure, interpolating the values between the times & extended flat beyond both ends.
+class ParametersPiecewiseLinear : public ParametersPiecewise
+{
+
+public:
+    //! \brief Constructor. Throws std::invalid_argument unless the times are increasing, one per value.
+    //! \param p_times - The nodes.
+    //! \param p_values
+    ParametersPiecewiseLinear(std::vector<double> p_times, std::vector<double> p_values);
+    //! \brief A view of the \a arrays of another, nothing copied nor recomputed, so trusted as they are.
+    //! \param p_arrays
+    explicit ParametersPiecewiseLinear(Arrays p_arrays);
+
+    std::unique_ptr<ParametersInner> clone() const override;
+    ParametersInner * cloneInto(void * p_buffer, size_t p_capacity) const override;
+    double integral(double time1, double time2) const override;
+    double integralSquare(double time1, double time2) const override;
+
+private:
+    static void integrate(Span<const double> p_times, Span<const double> p_values, Span<double> p_integrals,
+                          Span<double> p_integralsSquare);
+
+    //! \brief \f$\int_{t_0}^t f\f$, or of \f$f^2\f$ if \p p_square.
+    double integralFromFirst(double p_time, bool p_square) const;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Derived>
+ParametersInner * ParametersInner::cloneInto(const Derived & p_this, void * p_buffer, size_t p_capacity)
+{
+    if constexpr (alignof(Derived) <= alignof(std::max_align_t) && std::is_nothrow_copy_constructible<Derived>::value)
+    {
+        if (sizeof(Derived) <= p_capacity)
+        {
+            return ::new (p_buffer) Derived(p_this);
+        }
+    }
+    return nullptr;
+}
+
+inline double Parameters::integral(double time1, double time2) const
+{
+    return m_isConstant ? m_constant * (time2 - time1) : m_pImpl->integral(time1, time2);
+}
+
+inline double Parameters::integralSquare(double time1, double time2) const
+{
+    return m_isConstant ? m_constant * m_constant * (time2 - time1) : m_pImpl->integralSquare(time1, time2);
+}
+
 } // namespace der
 
 #endif // PARAMETERS_H
@@ -5,7 +5,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <vector>
 
 #include "payoff.h"
@@ -21,16 +24,261 @@ PathDependent::PathDependent(std::vector<double> p_lookAtTimes) : m_lookAtTimes(
 
 PathDependent::~PathDependent() = default;
 
-std::vector<double> PathDependent::lookAtTimes() const { return m_lookAtTimes; }
+const std::vector<double> & PathDependent::lookAtTimes() const { return m_lookAtTimes; }
+
+size_t PathDependent::numberOfProducts() const { return 1; }
+
+size_t PathDependent::productCashFlows(size_t /*p_product*/, const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    return cashFlows(p_spots, p_flows);
+}
+
+size_t PathDependent::cashFlowDerivatives(const std::vector<double> & /*p_spots*/, const std::vector<double> & /*p_spotTangents*/,
+                                          Span<CashFlow> /*p_flows*/) const
+{
+    throw std::logic_error("PathDependent::cashFlowDerivatives: no pathwise derivatives available for this product.");
+}
+
+size_t PathDependent::productCashFlowDerivatives(size_t /*p_product*/, const std::vector<double> & p_spots,
+                                                 const std::vector<double> & p_spotTangents, Span<CashFlow> p_flows) const
+{
+    return cashFlowDerivatives(p_spots, p_spotTangents, p_flows);
+}
+
+std::vector<AADCashFlow> PathDependent::cashFlowsAAD(const std::vector<aad::Number> & /*p_spots*/,
+                                                     std::vector<AADCashFlow> && /*p_flows*/) const
+{
+    throw std::logic_error("PathDependent::cashFlowsAAD: no adjoint cash-flows available for this product.");
+}
+
+void PathDependent::setBridge(double /*p_S0*/, const std::vector<double> & /*p_variances*/) {}
+
+// PathDependentMultiple
+
+PathDependentMultiple::PathDependentMultiple(std::vector<std::unique_ptr<PathDependent>> p_products)
+    : PathDependent({}), m_products(std::move(p_products))
+{
+    precalculate();
+}
+
+PathDependentMultiple::PathDependentMultiple(const PathDependentMultiple & p_other)
+    : PathDependent(p_other)
+    , m_spotIndices(p_other.m_spotIndices)
+    , m_allSpots(p_other.m_allSpots)
+    , m_flowOffsets(p_other.m_flowOffsets)
+    , m_spots(p_other.m_spots)
+    , m_spotTangents(p_other.m_spotTangents)
+    , m_spotsAAD(p_other.m_spotsAAD)
+    , m_flowsAAD(p_other.m_flowsAAD)
+{
+    for (const auto & product : p_other.m_products)
+    {
+        m_products.push_back(product->clone());
+    }
+}
+
+PathDependentMultiple & PathDependentMultiple::operator=(const PathDependentMultiple & p_other)
+{
+    if (this != &p_other)
+    {
+        *this = PathDependentMultiple(p_other);
+    }
+    return *this;
+}
+
+void PathDependentMultiple::precalculate()
+{
+    for (const auto & product : m_products)
+    {
+        const auto & times = product->lookAtTimes();
+        m_lookAtTimes.insert(m_lookAtTimes.end(), times.begin(), times.end());
+    }
+
+    std::sort(m_lookAtTimes.begin(), m_lookAtTimes.end());
+    m_lookAtTimes.erase(std::unique(m_lookAtTimes.begin(), m_lookAtTimes.end()), m_lookAtTimes.end());
+
+    size_t offset = 0;
+    for (const auto & product : m_products)
+    {
+        const auto & times = product->lookAtTimes();
+
+        std::vector<size_t> indices(times.size());
+        std::transform(times.begin(), times.end(), indices.begin(), [this](auto time) {
+            return static_cast<size_t>(std::lower_bound(m_lookAtTimes.begin(), m_lookAtTimes.end(), time) - m_lookAtTimes.begin());
+        });
+
+        m_allSpots.push_back(times == m_lookAtTimes);
+        m_spotIndices.push_back(std::move(indices));
+        m_spots.emplace_back(times.size());
+        m_spotTangents.emplace_back(times.size());
+        m_spotsAAD.emplace_back(times.size());
+
+        m_flowOffsets.push_back(offset);
+        offset += product->possibleCashFlowTimes().size();
+    }
+}
+
+std::unique_ptr<PathDependent> PathDependentMultiple::clone() const { return std::make_unique<PathDependentMultiple>(*this); }
+
+size_t PathDependentMultiple::maxNumberOfCashFlows() const
+{
+    return std::accumulate(m_products.begin(), m_products.end(), size_t{0},
+                           [](size_t sum, const auto & product) { return sum + product->maxNumberOfCashFlows(); });
+}
+
+std::vector<double> PathDependentMultiple::possibleCashFlowTimes() const
+{
+    std::vector<double> ret;
+    for (const auto & product : m_products)
+    {
+        auto times = product->possibleCashFlowTimes();
+        ret.insert(ret.end(), times.begin(), times.end());
+    }
+    return ret;
+}
+
+size_t PathDependentMultiple::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    // the constituents write one after another, the buffer holds the sum of their maxima
+    size_t written = 0;
+    for (size_t i = 0; i < m_products.size(); ++i)
+    {
+        written += productCashFlows(i, p_spots, p_flows.subspan(written));
+    }
+    return written;
+}
+
+size_t PathDependentMultiple::numberOfProducts() const { return m_products.size(); }
+
+size_t PathDependentMultiple::productCashFlows(size_t p_product, const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    size_t written;
+    if (m_allSpots[p_product])
+    {
+        written = m_products[p_product]->cashFlows(p_spots, p_flows);
+    }
+    else
+    {
+        // gather the product's own spots out of the merged ones
+        auto & spots = m_spots[p_product];
+        const auto & indices = m_spotIndices[p_product];
+        for (size_t j = 0; j < indices.size(); ++j)
+        {
+            spots[j] = p_spots[indices[j]];
+        }
+
+        written = m_products[p_product]->cashFlows(spots, p_flows);
+    }
+
+    // refer to the concatenated cash-flow times
+    for (size_t k = 0; k < written; ++k)
+    {
+        p_flows[k].timeIndex += m_flowOffsets[p_product];
+    }
+
+    return written;
+}
+
+size_t PathDependentMultiple::cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                                                  Span<CashFlow> p_flows) const
+{
+    size_t written = 0;
+    for (size_t i = 0; i < m_products.size(); ++i)
+    {
+        written += productCashFlowDerivatives(i, p_spots, p_spotTangents, p_flows.subspan(written));
+    }
+    return written;
+}
+
+size_t PathDependentMultiple::productCashFlowDerivatives(size_t p_product, const std::vector<double> & p_spots,
+                                                         const std::vector<double> & p_spotTangents, Span<CashFlow> p_flows) const
+{
+    size_t written;
+    if (m_allSpots[p_product])
+    {
+        written = m_products[p_product]->cashFlowDerivatives(p_spots, p_spotTangents, p_flows);
+    }
+    else
+    {
+        auto & spots = m_spots[p_product];
+        auto & tangents = m_spotTangents[p_product];
+        const auto & indices = m_spotIndices[p_product];
+        for (size_t j = 0; j < indices.size(); ++j)
+        {
+            spots[j] = p_spots[indices[j]];
+            tangents[j] = p_spotTangents[indices[j]];
+        }
+
+        written = m_products[p_product]->cashFlowDerivatives(spots, tangents, p_flows);
+    }
+
+    for (size_t k = 0; k < written; ++k)
+    {
+        p_flows[k].timeIndex += m_flowOffsets[p_product];
+    }
+
+    return written;
+}
+
+std::vector<AADCashFlow> PathDependentMultiple::cashFlowsAAD(const std::vector<aad::Number> & p_spots,
+                                                             std::vector<AADCashFlow> && p_flows) const
+{
+    p_flows.clear();
+    for (size_t i = 0; i < m_products.size(); ++i)
+    {
+        if (m_allSpots[i])
+        {
+            m_flowsAAD = m_products[i]->cashFlowsAAD(p_spots, std::move(m_flowsAAD));
+        }
+        else
+        {
+            auto & spots = m_spotsAAD[i];
+            const auto & indices = m_spotIndices[i];
+            for (size_t j = 0; j < indices.size(); ++j)
+            {
+                spots[j] = p_spots[indices[j]];
+            }
+
+            m_flowsAAD = m_products[i]->cashFlowsAAD(spots, std::move(m_flowsAAD));
+        }
+
+        for (auto & flow : m_flowsAAD)
+        {
+            flow.timeIndex += m_flowOffsets[i];
+        }
+        p_flows.insert(p_flows.end(), m_flowsAAD.begin(), m_flowsAAD.end());
+    }
+    return std::move(p_flows);
+}
+
+void PathDependentMultiple::setBridge(double p_S0, const std::vector<double> & p_variances)
+{
+    std::vector<double> variances;
+    for (size_t i = 0; i < m_products.size(); ++i)
+    {
+        // the variance from the previous look-at time of the product to the current one
+        variances.assign(m_spotIndices[i].size(), 0.0);
+        size_t step = 0;
+        for (size_t j = 0; j < m_spotIndices[i].size(); ++j)
+        {
+            for (; step <= m_spotIndices[i][j]; ++step)
+            {
+                variances[j] += p_variances[step];
+            }
+        }
+
+        m_products[i]->setBridge(p_S0, variances);
+    }
+}
 
 // AsianOption
 
 AsianOption::AsianOption(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff)
-    : PathDependent(p_lookAtTimes), m_delivery(p_delivery), m_pPayoff(p_payoff.clone())
+    : StreamingPathDependent(p_lookAtTimes), m_delivery(p_delivery), m_pPayoff(p_payoff.clone())
 {}
 
 AsianOption::AsianOption(const AsianOption & p_other)
-    : PathDependent(p_other), m_delivery(p_other.m_delivery), m_pPayoff(p_other.m_pPayoff->clone())
+    : StreamingPathDependent(p_other), m_delivery(p_other.m_delivery), m_pPayoff(p_other.m_pPayoff->clone())
 {}
 
 AsianOption & AsianOption::operator=(const AsianOption & p_other)
@@ -38,7 +286,7 @@ AsianOption & AsianOption::operator=(const AsianOption & p_other)
     if (this != &p_other)
     {
         // call without returning
-        PathDependent::operator=(p_other);
+        StreamingPathDependent::operator=(p_other);
         this->m_delivery = p_other.m_delivery;
         this->m_pPayoff = p_other.m_pPayoff->clone();
     }
@@ -49,6 +297,10 @@ size_t AsianOption::maxNumberOfCashFlows() const { return 1; }
 
 std::vector<double> AsianOption::possibleCashFlowTimes() const { return {m_delivery}; }
 
+size_t AsianOption::stateSize() const { return 1; }
+
+void AsianOption::init(Span<double> p_states) const { std::fill(p_states.begin(), p_states.end(), 0.0); }
+
 // AsianOptionArith
 
 AsianOptionArith::AsianOptionArith(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff)
@@ -57,14 +309,56 @@ AsianOptionArith::AsianOptionArith(const std::vector<double> & p_lookAtTimes, do
 
 std::unique_ptr<PathDependent> AsianOptionArith::clone() const { return std::make_unique<AsianOptionArith>(*this); }
 
-std::vector<CashFlow> AsianOptionArith::cashFlows(const std::vector<double> & p_spots, std::vector<CashFlow> && p_flows) const
+size_t AsianOptionArith::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
 {
-    p_flows.resize(1);
     double sum = std::accumulate(p_spots.begin(), p_spots.end(), 0.0);
 
     p_flows[0].timeIndex = 0;
     // the payoff is a function of the arithmetic average
     p_flows[0].amount = (*m_pPayoff)(sum / m_lookAtTimes.size());
+    return 1;
+}
+
+size_t AsianOptionArith::cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                                             Span<CashFlow> p_flows) const
+{
+    double n = static_cast<double>(m_lookAtTimes.size());
+    double average = std::accumulate(p_spots.begin(), p_spots.end(), 0.0) / n;
+    double averageTangent = std::accumulate(p_spotTangents.begin(), p_spotTangents.end(), 0.0) / n;
+
+    p_flows[0].timeIndex = 0;
+    // chain rule through the average
+    p_flows[0].amount = m_pPayoff->derivative(average) * averageTangent;
+    return 1;
+}
+
+void AsianOptionArith::observe(size_t /*p_date*/, Span<const double> p_spots, Span<double> p_states) const
+{
+    for (size_t p = 0; p < p_spots.size(); ++p)
+    {
+        p_states[p] += p_spots[p];
+    }
+}
+
+size_t AsianOptionArith::finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const
+{
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (*m_pPayoff)(p_states[p_path] / m_lookAtTimes.size());
+    return 1;
+}
+
+std::vector<AADCashFlow> AsianOptionArith::cashFlowsAAD(const std::vector<aad::Number> & p_spots,
+                                                        std::vector<AADCashFlow> && p_flows) const
+{
+    p_flows.resize(1);
+    aad::Number sum = p_spots[0];
+    for (size_t i = 1; i < p_spots.size(); ++i)
+    {
+        sum += p_spots[i];
+    }
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (*m_pPayoff)(sum / static_cast<double>(m_lookAtTimes.size()));
     return std::move(p_flows);
 }
 
@@ -76,16 +370,378 @@ AsianOptionGeom::AsianOptionGeom(const std::vector<double> & p_lookAtTimes, doub
 
 std::unique_ptr<PathDependent> AsianOptionGeom::clone() const { return std::make_unique<AsianOptionGeom>(*this); }
 
-std::vector<CashFlow> AsianOptionGeom::cashFlows(const std::vector<double> & p_spots, std::vector<CashFlow> && p_flows) const
+size_t AsianOptionGeom::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
 {
-    p_flows.resize(1);
-    double tot =
-        std::accumulate(p_spots.begin(), p_spots.end(), 1.0, [](auto & runningProd, auto curr) { return runningProd *= curr; });
+    // summing the logs, as does observe: the product of the spots would overflow over a few hundred dates
+    double sumLog =
+        std::accumulate(p_spots.begin(), p_spots.end(), 0.0, [](double p_sum, double p_spot) { return p_sum + std::log(p_spot); });
 
     p_flows[0].timeIndex = 0;
     // the payoff is a function of the geometric average
-    p_flows[0].amount = (*m_pPayoff)(std::pow(tot, 1.0 / m_lookAtTimes.size()));
+    p_flows[0].amount = (*m_pPayoff)(std::exp(sumLog / static_cast<double>(m_lookAtTimes.size())));
+    return 1;
+}
+
+size_t AsianOptionGeom::cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                                            Span<CashFlow> p_flows) const
+{
+    double n = static_cast<double>(m_lookAtTimes.size());
+    double sumLog =
+        std::accumulate(p_spots.begin(), p_spots.end(), 0.0, [](double p_sum, double p_spot) { return p_sum + std::log(p_spot); });
+    double average = std::exp(sumLog / n);
+
+    // d G = G / n * sum(dS_i / S_i)
+    double relativeTangent = std::inner_product(p_spotTangents.begin(), p_spotTangents.end(), p_spots.begin(), 0.0, std::plus<>(),
+                                                std::divides<>());
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = m_pPayoff->derivative(average) * average * relativeTangent / n;
+    return 1;
+}
+
+void AsianOptionGeom::observe(size_t /*p_date*/, Span<const double> p_spots, Span<double> p_states) const
+{
+    // a running product would overflow over many dates
+    for (size_t p = 0; p < p_spots.size(); ++p)
+    {
+        p_states[p] += std::log(p_spots[p]);
+    }
+}
+
+size_t AsianOptionGeom::finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const
+{
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (*m_pPayoff)(std::exp(p_states[p_path] / m_lookAtTimes.size()));
+    return 1;
+}
+
+std::vector<AADCashFlow> AsianOptionGeom::cashFlowsAAD(const std::vector<aad::Number> & p_spots,
+                                                       std::vector<AADCashFlow> && p_flows) const
+{
+    p_flows.resize(1);
+    // averaging the logs records fewer nodes than the product & the power
+    aad::Number sumLog = log(p_spots[0]);
+    for (size_t i = 1; i < p_spots.size(); ++i)
+    {
+        sumLog += log(p_spots[i]);
+    }
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (*m_pPayoff)(exp(sumLog / static_cast<double>(m_lookAtTimes.size())));
     return std::move(p_flows);
 }
 
+double AsianOptionGeom::blackScholesPrice(double p_S0, const Parameters & p_r, const Parameters & p_d, const Parameters & p_vol) const
+{
+    auto times = m_lookAtTimes;
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+
+    // the log of the geometric mean is the average of the gaussian log-spots:
+    // the mean averages the drifts, the variance sums up Cov(log S_i, log S_j) = Var(log S_min(i, j))
+    double mean = 0.0;
+    double variance = 0.0;
+    for (size_t k = 0; k < n; ++k)
+    {
+        double varK = p_vol.integralSquare(0.0, times[k]);
+        mean += p_r.integral(0.0, times[k]) - p_d.integral(0.0, times[k]) - 0.5 * varK;
+        // the number of pairs (i, j) whose earlier time is times[k]
+        variance += varK * static_cast<double>(2 * (n - k) - 1);
+    }
+    mean = std::log(p_S0) + mean / n;
+    variance /= static_cast<double>(n * n);
+
+    double forward = std::exp(mean + 0.5 * variance);
+    return std::exp(-p_r.integral(0.0, m_delivery)) * m_pPayoff->lognormalExpectation(forward, std::sqrt(variance));
+}
+
+// BarrierOption
+
+BarrierOption::BarrierOption(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff, double p_barrier,
+                             BarrierType p_type)
+    : StreamingPathDependent(p_lookAtTimes)
+    , m_delivery(p_delivery)
+    , m_pPayoff(p_payoff.clone())
+    , m_logBarrier(std::log(p_barrier))
+    , m_type(p_type)
+    , m_sign((p_type == BarrierType::UpAndOut || p_type == BarrierType::UpAndIn) ? 1.0 : -1.0)
+{}
+
+BarrierOption::BarrierOption(const BarrierOption & p_other)
+    : StreamingPathDependent(p_other)
+    , m_delivery(p_other.m_delivery)
+    , m_pPayoff(p_other.m_pPayoff->clone())
+    , m_logBarrier(p_other.m_logBarrier)
+    , m_type(p_other.m_type)
+    , m_sign(p_other.m_sign)
+    , m_logS0(p_other.m_logS0)
+    , m_inverseVariances(p_other.m_inverseVariances)
+{}
+
+BarrierOption & BarrierOption::operator=(const BarrierOption & p_other)
+{
+    if (this != &p_other)
+    {
+        *this = BarrierOption(p_other);
+    }
+    return *this;
+}
+
+std::unique_ptr<PathDependent> BarrierOption::clone() const { return std::make_unique<BarrierOption>(*this); }
+
+size_t BarrierOption::maxNumberOfCashFlows() const { return 1; }
+
+std::vector<double> BarrierOption::possibleCashFlowTimes() const { return {m_delivery}; }
+
+size_t BarrierOption::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    double survival = survivalProbability(p_spots);
+    bool knockOut = m_type == BarrierType::UpAndOut || m_type == BarrierType::DownAndOut;
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (knockOut ? survival : 1.0 - survival) * (*m_pPayoff)(p_spots.back());
+    return 1;
+}
+
+void BarrierOption::setBridge(double p_S0, const std::vector<double> & p_variances)
+{
+    m_logS0 = std::log(p_S0);
+
+    m_inverseVariances.resize(p_variances.size());
+    std::transform(p_variances.begin(), p_variances.end(), m_inverseVariances.begin(),
+                   [](double variance) { return variance > 0.0 ? 1.0 / variance : std::numeric_limits<double>::infinity(); });
+}
+
+size_t BarrierOption::stateSize() const { return 3; }
+
+void BarrierOption::init(Span<double> p_states) const
+{
+    // the survival probabilities, the distances & the last spots
+    size_t nPaths = p_states.size() / 3;
+    // with no bridge, the start is taken as infinitely far
+    double distance = m_inverseVariances.empty() ? std::numeric_limits<double>::infinity() : m_sign * (m_logBarrier - m_logS0);
+
+    std::fill(p_states.begin(), p_states.begin() + nPaths, distance > 0.0 ? 1.0 : 0.0);
+    std::fill(p_states.begin() + nPaths, p_states.begin() + 2 * nPaths, distance);
+    std::fill(p_states.begin() + 2 * nPaths, p_states.end(), 0.0);
+}
+
+void BarrierOption::observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const
+{
+    size_t nPaths = p_spots.size();
+    double * survivals = p_states.data();
+    double * distances = p_states.data() + nPaths;
+    double inverseVariance = m_inverseVariances.empty() ? std::numeric_limits<double>::infinity() : m_inverseVariances[p_date];
+
+    for (size_t p = 0; p < nPaths; ++p)
+    {
+        double current = m_sign * (m_logBarrier - std::log(p_spots[p]));
+        // knocked out on either date, or by the bridge in between
+        double survival =
+            (current > 0.0 && distances[p] > 0.0) ? 1.0 - std::exp(-2.0 * distances[p] * current * inverseVariance) : 0.0;
+
+        survivals[p] *= survival;
+        distances[p] = current;
+    }
+
+    std::copy(p_spots.begin(), p_spots.end(), p_states.data() + 2 * nPaths);
+}
+
+size_t BarrierOption::finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const
+{
+    size_t nPaths = p_states.size() / 3;
+    double survival = p_states[p_path];
+    bool knockOut = m_type == BarrierType::UpAndOut || m_type == BarrierType::DownAndOut;
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (knockOut ? survival : 1.0 - survival) * (*m_pPayoff)(p_states[2 * nPaths + p_path]);
+    return 1;
+}
+
+double BarrierOption::survivalProbability(const std::vector<double> & p_spots) const
+{
+    bool bridged = !m_inverseVariances.empty();
+    // the distances to the barrier in log-spot, positive on the side of survival
+    double previous = m_sign * (m_logBarrier - m_logS0);
+    if (bridged && previous <= 0.0)
+    {
+        return 0.0;
+    }
+
+    double survival = 1.0;
+    for (size_t i = 0; i < p_spots.size(); ++i)
+    {
+        double current = m_sign * (m_logBarrier - std::log(p_spots[i]));
+        if (current <= 0.0)
+        {
+            return 0.0;
+        }
+
+        // the probability of the bridge not crossing in between
+        if (bridged)
+        {
+            survival *= 1.0 - std::exp(-2.0 * previous * current * m_inverseVariances[i]);
+        }
+        previous = current;
+    }
+
+    return survival;
+}
+
+// StreamingPathDependent
+
+size_t StreamingPathDependent::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    m_state.resize(stateSize());
+
+    init(m_state);
+    for (size_t i = 0; i < p_spots.size(); ++i)
+    {
+        observe(i, {&p_spots[i], 1}, m_state);
+    }
+
+    return finish(m_state, 0, p_flows);
+}
+
+// LookbackOption
+
+LookbackOption::LookbackOption(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff,
+                               Extremum p_extremum, LookbackStrike p_strike)
+    : StreamingPathDependent(p_lookAtTimes)
+    , m_delivery(p_delivery)
+    , m_pPayoff(p_payoff.clone())
+    , m_extremum(p_extremum)
+    , m_strike(p_strike)
+{}
+
+LookbackOption::LookbackOption(const LookbackOption & p_other)
+    : StreamingPathDependent(p_other)
+    , m_delivery(p_other.m_delivery)
+    , m_pPayoff(p_other.m_pPayoff->clone())
+    , m_extremum(p_other.m_extremum)
+    , m_strike(p_other.m_strike)
+{}
+
+LookbackOption & LookbackOption::operator=(const LookbackOption & p_other)
+{
+    if (this != &p_other)
+    {
+        *this = LookbackOption(p_other);
+    }
+    return *this;
+}
+
+std::unique_ptr<PathDependent> LookbackOption::clone() const { return std::make_unique<LookbackOption>(*this); }
+
+size_t LookbackOption::maxNumberOfCashFlows() const { return 1; }
+
+std::vector<double> LookbackOption::possibleCashFlowTimes() const { return {m_delivery}; }
+
+size_t LookbackOption::stateSize() const { return 2; }
+
+void LookbackOption::init(Span<double> p_states) const
+{
+    // the extrema, then the last spots
+    size_t nPaths = p_states.size() / 2;
+    double start = m_extremum == Extremum::Maximum ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+
+    std::fill(p_states.begin(), p_states.begin() + nPaths, start);
+    std::fill(p_states.begin() + nPaths, p_states.end(), 0.0);
+}
+
+void LookbackOption::observe(size_t /*p_date*/, Span<const double> p_spots, Span<double> p_states) const
+{
+    size_t nPaths = p_spots.size();
+    double * extrema = p_states.data();
+    double * lasts = p_states.data() + nPaths;
+
+    if (m_extremum == Extremum::Maximum)
+    {
+        for (size_t p = 0; p < nPaths; ++p)
+        {
+            extrema[p] = std::max(extrema[p], p_spots[p]);
+        }
+    }
+    else
+    {
+        for (size_t p = 0; p < nPaths; ++p)
+        {
+            extrema[p] = std::min(extrema[p], p_spots[p]);
+        }
+    }
+
+    std::copy(p_spots.begin(), p_spots.end(), lasts);
+}
+
+size_t LookbackOption::finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const
+{
+    size_t nPaths = p_states.size() / 2;
+    double extremum = p_states[p_path];
+    double last = p_states[nPaths + p_path];
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = (*m_pPayoff)(m_strike == LookbackStrike::Fixed ? extremum : last - extremum);
+    return 1;
+}
+
+// CliquetOption
+
+CliquetOption::CliquetOption(const std::vector<double> & p_lookAtTimes, double p_delivery, double p_localFloor, double p_localCap,
+                             double p_globalFloor, double p_globalCap, double p_notional)
+    : StreamingPathDependent(p_lookAtTimes)
+    , m_delivery(p_delivery)
+    , m_localFloor(p_localFloor)
+    , m_localCap(p_localCap)
+    , m_globalFloor(p_globalFloor)
+    , m_globalCap(p_globalCap)
+    , m_notional(p_notional)
+{
+    if (m_lookAtTimes.size() < 2)
+    {
+        throw std::invalid_argument("CliquetOption: at least two reset times are needed for a return.");
+    }
+}
+
+std::unique_ptr<PathDependent> CliquetOption::clone() const { return std::make_unique<CliquetOption>(*this); }
+
+size_t CliquetOption::maxNumberOfCashFlows() const { return 1; }
+
+std::vector<double> CliquetOption::possibleCashFlowTimes() const { return {m_delivery}; }
+
+size_t CliquetOption::stateSize() const { return 2; }
+
+void CliquetOption::init(Span<double> p_states) const
+{
+    // the last spots, then the sums of the returns
+    std::fill(p_states.begin(), p_states.end(), 0.0);
+}
+
+void CliquetOption::observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const
+{
+    size_t nPaths = p_spots.size();
+    double * lasts = p_states.data();
+    double * sums = p_states.data() + nPaths;
+
+    // the first date only fixes the reference
+    if (p_date > 0)
+    {
+        for (size_t p = 0; p < nPaths; ++p)
+        {
+            sums[p] += std::min(std::max(p_spots[p] / lasts[p] - 1.0, m_localFloor), m_localCap);
+        }
+    }
+
+    std::copy(p_spots.begin(), p_spots.end(), lasts);
+}
+
+size_t CliquetOption::finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const
+{
+    size_t nPaths = p_states.size() / 2;
+    double sum = p_states[nPaths + p_path];
+
+    p_flows[0].timeIndex = 0;
+    p_flows[0].amount = m_notional * std::min(std::max(sum, m_globalFloor), m_globalCap);
+    return 1;
+}
+
 } // namespace der
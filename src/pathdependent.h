@@ -8,9 +8,16 @@
 #ifndef PATHDEPENDENT_H
 #define PATHDEPENDENT_H
 
+#include <cmath>
 #include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
+#include "aad.h"
+#include "parameters.h"
+#include "span.h"
+
 namespace der
 {
 
@@ -30,6 +37,13 @@ struct CashFlow
     size_t timeIndex;
 };
 
+//! \brief A cash-flow whose amount is recorded on the \a aad::Tape, c.f. \a CashFlow.
+struct AADCashFlow
+{
+    aad::Number amount;
+    size_t timeIndex;
+};
+
 //! \brief The abstract interface for path-dependent options.
 class PathDependent
 {
@@ -48,7 +62,7 @@ public:
 
     //! \brief The times that are relevant to the pay-off function of the product.
     //! This is used, for example, to request spot values from an engine.
-    std::vector<double> lookAtTimes() const;
+    const std::vector<double> & lookAtTimes() const;
 
     // C++ 20+ allows for virtual constexpr functions, as would come into play here,
     // since we need virtual for the interface, but an implementation could be constexpr - i.e. an option only pays at the end.
@@ -63,17 +77,149 @@ public:
 
     //! \brief Contains the cash-flows stemming from the derivative.
     //! \param p_spots
+    //! \param p_flows - The caller's buffer of at least \a maxNumberOfCashFlows, written from the start.
+    //! \return The number of cash-flows written.
+    // NOTE: a span into the caller's storage rather than a moved vector, so that a path allocates nothing, not even a resize.
+    virtual size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const = 0;
+
+    //! \brief The number of products making up this one, c.f. \a PathDependentMultiple. A plain product is just itself.
+    virtual size_t numberOfProducts() const;
+    //! \brief Contains the cash-flows stemming from the \p p_product-th constituent product only.
+    //! The time indices still refer to \a possibleCashFlowTimes of the whole.
+    //! \param p_product
+    //! \param p_spots
+    //! \param p_flows
+    //! \return The number of cash-flows written.
+    virtual size_t productCashFlows(size_t p_product, const std::vector<double> & p_spots, Span<CashFlow> p_flows) const;
+
+    //! \brief The directional derivatives of the cash-flows, used for pathwise Greeks.
+    //! The amounts returned are \f$\sum_i \frac{\partial amount}{\partial S_i} \dot{S_i}\f$, where the tangents \f$\dot{S_i}\f$ are
+    //! the sensitivities of the spots to the parameter in question. Only meaningful for Lipschitz payoffs.
+    //! The default implementation throws.
+    //! \param p_spots
+    //! \param p_spotTangents
+    //! \param p_flows
+    //! \return The number of cash-flows written.
+    virtual size_t cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                                       Span<CashFlow> p_flows) const;
+    //! \brief The directional derivatives of the \p p_product-th constituent's cash-flows only, c.f. \a productCashFlows.
+    virtual size_t productCashFlowDerivatives(size_t p_product, const std::vector<double> & p_spots,
+                                              const std::vector<double> & p_spotTangents, Span<CashFlow> p_flows) const;
+
+    //! \brief Contains the cash-flows stemming from the derivative, recorded on the \a aad::Tape for adjoint sensitivities.
+    //! The default implementation throws.
+    //! \param p_spots
     //! \param p_flows
     //! \return
-    // NOTE: returns a mutated version of the input, preferring this to input/output params.
-    virtual std::vector<CashFlow> cashFlows(const std::vector<double> & p_spots, std::vector<CashFlow> && p_flows) const = 0;
+    virtual std::vector<AADCashFlow> cashFlowsAAD(const std::vector<aad::Number> & p_spots, std::vector<AADCashFlow> && p_flows) const;
+
+    //! \brief Informs the product of the process between the look-at times, for products correcting for what happens in between,
+    //! e.g. \a BarrierOption. Called by the engines whose process is log-normal over the steps, i.e. a Brownian bridge in the
+    //! log-spot between the look-at times. The default implementation ignores it.
+    //! \param p_S0 - The spot @ time 0.
+    //! \param p_variances - The variances of the log-spot over the steps up to each look-at time.
+    virtual void setBridge(double p_S0, const std::vector<double> & p_variances);
 
 protected:
     std::vector<double> m_lookAtTimes;
 };
 
+//! \brief A collection of products evaluated on the same paths.
+//! The look-at times are the merged (sorted, unique) times of the constituents, the possible cash-flow times are concatenated.
+//! As a single product, it pays the sum of the constituents' cash-flows, i.e. it is a portfolio.
+class PathDependentMultiple : public PathDependent
+{
+public:
+    //! \brief PathDependentMultiple
+    //! \param p_products - The constituents.
+    explicit PathDependentMultiple(std::vector<std::unique_ptr<PathDependent>> p_products);
+
+    PathDependentMultiple(const PathDependentMultiple & p_other);
+    PathDependentMultiple(PathDependentMultiple &&) = default;
+    PathDependentMultiple & operator=(const PathDependentMultiple & p_other);
+    PathDependentMultiple & operator=(PathDependentMultiple &&) = default;
+    ~PathDependentMultiple() override = default;
+
+    std::unique_ptr<PathDependent> clone() const override;
+
+    size_t maxNumberOfCashFlows() const override;
+    std::vector<double> possibleCashFlowTimes() const override;
+
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+    size_t numberOfProducts() const override;
+    size_t productCashFlows(size_t p_product, const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+    size_t cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                               Span<CashFlow> p_flows) const override;
+    size_t productCashFlowDerivatives(size_t p_product, const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                                      Span<CashFlow> p_flows) const override;
+
+    std::vector<AADCashFlow> cashFlowsAAD(const std::vector<aad::Number> & p_spots, std::vector<AADCashFlow> && p_flows) const override;
+
+    //! \brief Passes the variances on, summed over the steps between each constituent's own look-at times.
+    void setBridge(double p_S0, const std::vector<double> & p_variances) override;
+
+private:
+    //! \brief Merges the look-at times & sets up the index mappings.
+    void precalculate();
+
+    std::vector<std::unique_ptr<PathDependent>> m_products;
+
+    //! \brief For each product, the indices of its look-at times in the merged ones.
+    std::vector<std::vector<size_t>> m_spotIndices;
+    //! \brief For each product, whether its look-at times are the merged ones - no gathering of the spots necessary.
+    std::vector<bool> m_allSpots;
+    //! \brief For each product, the offset of its cash-flow times in the concatenated ones.
+    std::vector<size_t> m_flowOffsets;
+
+    //! \brief used as scratchpad for the spots of the individual products
+    mutable std::vector<std::vector<double>> m_spots;
+    //! \brief used as scratchpad for the spot tangents of the individual products
+    mutable std::vector<std::vector<double>> m_spotTangents;
+    //! \brief used as scratchpad for the taped spots of the individual products
+    mutable std::vector<std::vector<aad::Number>> m_spotsAAD;
+    //! \brief used as scratchpad for the taped cash-flows of the individual products
+    mutable std::vector<AADCashFlow> m_flowsAAD;
+};
+
+//! \brief A path-dependent product evaluated incrementally, date by date, on a fixed-size running state per path.
+//! Engines producing the paths in blocks, date by date for many paths at once, can so evaluate the product without ever holding
+//! the full paths. The states of a block of paths are laid out component by component, i.e. the \p k-th component of the
+//! \p p-th of \f$N\f$ paths is @ \f$k N + p\f$, so that the updates over the paths are contiguous & vectorize.
+//! \a cashFlows is implemented on top, as a block of a single path.
+class StreamingPathDependent : public PathDependent
+{
+public:
+    using PathDependent::PathDependent;
+
+    //! \brief The number of doubles of the running state of a path.
+    virtual size_t stateSize() const = 0;
+
+    //! \brief Sets up the states of a block of paths, before the first look-at time.
+    //! \param p_states - \a stateSize per path.
+    virtual void init(Span<double> p_states) const = 0;
+    //! \brief Updates the states of a block of paths with the spots @ a look-at time.
+    //! \param p_date - The index of the look-at time; the dates are observed in order.
+    //! \param p_spots - One per path.
+    //! \param p_states
+    virtual void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const = 0;
+    //! \brief The cash-flows of a path, once all the look-at times have been observed.
+    //! \param p_states - The states of the block.
+    //! \param p_path - The index of the path in the block.
+    //! \param p_flows
+    //! \return The number of cash-flows written.
+    virtual size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const = 0;
+
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+private:
+    //! \brief used as scratchpad for the state of \a cashFlows' path, sized on its first call
+    mutable std::vector<double> m_state;
+};
+
 //! \brief An abstract class encapsulating common attributes to all Asian type options.
-class AsianOption : public PathDependent
+class AsianOption : public StreamingPathDependent
 {
 public:
     //! \brief AsianOption
@@ -91,9 +237,15 @@ public:
     size_t maxNumberOfCashFlows() const override;
     std::vector<double> possibleCashFlowTimes() const override;
 
+    //! \brief The state of a path is the running sum of its spots, or of their logs for the geometric average.
+    size_t stateSize() const override;
+    void init(Span<double> p_states) const override;
+
     // NOTE: these still remain pure:
     // std::unique_ptr<PathDependent> clone() const = 0;
-    // std::vector<CashFlow> cashFlows(const std::vector<double> &, std::vector<CashFlow> &&) const = 0;
+    // size_t cashFlows(const std::vector<double> &, Span<CashFlow>) const = 0;
+    // void observe(size_t, Span<const double>, Span<double>) const = 0;
+    // size_t finish(Span<const double>, size_t, Span<CashFlow>) const = 0;
 
 protected:
     double m_delivery;
@@ -117,8 +269,16 @@ public:
     //! the engine implementation according to \a lookAtTimes.
     //! \param p_spots
     //! \param p_flows
-    //! \return \p p_flows modified in-place.
-    std::vector<CashFlow> cashFlows(const std::vector<double> & p_spots, std::vector<CashFlow> && p_flows) const override;
+    //! \return The single cash-flow written.
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+    size_t cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                               Span<CashFlow> p_flows) const override;
+
+    void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const override;
+    size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const override;
+
+    std::vector<AADCashFlow> cashFlowsAAD(const std::vector<aad::Number> & p_spots, std::vector<AADCashFlow> && p_flows) const override;
 };
 
 //! \brief Geometric Asian option.
@@ -138,10 +298,289 @@ public:
     //! the engine implementation according to \p lookAtTimes.
     //! \param p_spots
     //! \param p_flows
-    //! \return \p p_flows modified in-place.
-    std::vector<CashFlow> cashFlows(const std::vector<double> & p_spots, std::vector<CashFlow> && p_flows) const override;
+    //! \return The single cash-flow written.
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+    size_t cashFlowDerivatives(const std::vector<double> & p_spots, const std::vector<double> & p_spotTangents,
+                               Span<CashFlow> p_flows) const override;
+
+    void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const override;
+    size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const override;
+
+    std::vector<AADCashFlow> cashFlowsAAD(const std::vector<aad::Number> & p_spots, std::vector<AADCashFlow> && p_flows) const override;
+
+    //! \brief The closed-form price under Black-Scholes dynamics: the geometric mean of log-normal spots is itself log-normal.
+    //! Requires the payoff to implement \a Payoff::lognormalExpectation. Useful as a control variate for \a AsianOptionArith.
+    //! \param p_S0 - The spot @ time 0.
+    //! \param p_r - The interest rate.
+    //! \param p_d - The dividend rate.
+    //! \param p_vol - The volatility.
+    //! \return The price.
+    double blackScholesPrice(double p_S0, const Parameters & p_r, const Parameters & p_d, const Parameters & p_vol) const;
+};
+
+//! \brief The kinds of barriers.
+enum class BarrierType
+{
+    UpAndOut,
+    UpAndIn,
+    DownAndOut,
+    DownAndIn
 };
 
+//! \brief A continuously monitored single barrier option paying a simple payoff of the last look-at spot.
+//! The barrier is checked on the look-at times and, in between, through the probability of the Brownian bridge of the log-spot
+//! crossing it: \f$p = \exp(-2 \log(B / S_{i-1}) \log(B / S_i) / \sigma^2_i)\f$. The cash-flow is the payoff weighted by the
+//! probability of knocking in/out given the spots, which is unbiased for continuous monitoring and has a lower variance than
+//! the indicator - a coarse grid of look-at times suffices.
+//! Requires an engine calling \a setBridge, e.g. \a ExoticBSEngine; otherwise the barrier is only monitored discretely.
+class BarrierOption : public StreamingPathDependent
+{
+public:
+    //! \brief BarrierOption
+    //! \param p_lookAtTimes: The monitoring times, the last one fixing the payoff.
+    //! \param p_delivery:  The expiry date can be different from the last monitoring date.
+    //! \param p_payoff:    The payoff of the spot at the last monitoring time, if knocked in/not knocked out.
+    //! \param p_barrier
+    //! \param p_type
+    BarrierOption(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff, double p_barrier,
+                  BarrierType p_type);
+
+    BarrierOption(const BarrierOption & p_other);
+    BarrierOption(BarrierOption &&) = default;
+    BarrierOption & operator=(const BarrierOption & p_other);
+    BarrierOption & operator=(BarrierOption &&) = default;
+    ~BarrierOption() override = default;
+
+    std::unique_ptr<PathDependent> clone() const override;
+
+    size_t maxNumberOfCashFlows() const override;
+    std::vector<double> possibleCashFlowTimes() const override;
+
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+
+    void setBridge(double p_S0, const std::vector<double> & p_variances) override;
+
+    //! \brief The state of a path is its probability of survival so far, its last distance to the barrier and its last spot.
+    size_t stateSize() const override;
+    void init(Span<double> p_states) const override;
+    void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const override;
+    size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const override;
+
+    //! \brief The probability of not crossing the barrier, given the spots @ the look-at times.
+    //! \param p_spots
+    //! \return
+    double survivalProbability(const std::vector<double> & p_spots) const;
+
+private:
+    double m_delivery;
+    std::unique_ptr<Payoff> m_pPayoff;
+    double m_logBarrier;
+    BarrierType m_type;
+    //! \brief The sign of the distances to the barrier in log-spot, so that they are positive on the side of survival.
+    double m_sign;
+
+    //! \brief The log-spot @ time 0, the start of the first bridge.
+    double m_logS0{0.0};
+    //! \brief The reciprocals of the variances over the steps, infinite for steps of no variance; empty for no bridge at all.
+    std::vector<double> m_inverseVariances;
+};
+
+//! \brief Whether a lookback fixes its strike or its spot by the extremum.
+enum class LookbackStrike
+{
+    //! \brief The payoff of the extremum.
+    Fixed,
+    //! \brief The payoff of the last spot less the extremum, e.g. a call with strike 0 on the minimum.
+    Floating
+};
+
+//! \brief The extrema of the spots over the look-at times.
+enum class Extremum
+{
+    Maximum,
+    Minimum
+};
+
+//! \brief A lookback option on the running maximum or minimum of the spots @ the look-at times.
+//! The state of a path is its extremum and its last spot.
+class LookbackOption : public StreamingPathDependent
+{
+public:
+    //! \brief LookbackOption
+    //! \param p_lookAtTimes: The monitoring times.
+    //! \param p_delivery:  The expiry date can be different from the last monitoring date.
+    //! \param p_payoff:    The payoff of the extremum for a fixed strike, of the last spot less the extremum for a floating one.
+    //! \param p_extremum
+    //! \param p_strike
+    LookbackOption(const std::vector<double> & p_lookAtTimes, double p_delivery, const Payoff & p_payoff, Extremum p_extremum,
+                   LookbackStrike p_strike);
+
+    LookbackOption(const LookbackOption & p_other);
+    LookbackOption(LookbackOption &&) = default;
+    LookbackOption & operator=(const LookbackOption & p_other);
+    LookbackOption & operator=(LookbackOption &&) = default;
+    ~LookbackOption() override = default;
+
+    std::unique_ptr<PathDependent> clone() const override;
+
+    size_t maxNumberOfCashFlows() const override;
+    std::vector<double> possibleCashFlowTimes() const override;
+
+    size_t stateSize() const override;
+    void init(Span<double> p_states) const override;
+    void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const override;
+    size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const override;
+
+private:
+    double m_delivery;
+    std::unique_ptr<Payoff> m_pPayoff;
+    Extremum m_extremum;
+    LookbackStrike m_strike;
+};
+
+//! \brief A cliquet: the sum of the periodic returns \f$S_i / S_{i - 1} - 1\f$ between the look-at times, each floored & capped
+//! locally, the sum floored & capped globally, times the notional. The first look-at time only fixes the first reference spot.
+//! The state of a path is its last spot and the running sum.
+class CliquetOption : public StreamingPathDependent
+{
+public:
+    //! \brief CliquetOption
+    //! \param p_lookAtTimes: The reset times, at least 2.
+    //! \param p_delivery:  The expiry date can be different from the last reset date.
+    //! \param p_localFloor
+    //! \param p_localCap
+    //! \param p_globalFloor
+    //! \param p_globalCap
+    //! \param p_notional
+    CliquetOption(const std::vector<double> & p_lookAtTimes, double p_delivery, double p_localFloor, double p_localCap,
+                  double p_globalFloor, double p_globalCap, double p_notional = 1.0);
+
+    std::unique_ptr<PathDependent> clone() const override;
+
+    size_t maxNumberOfCashFlows() const override;
+    std::vector<double> possibleCashFlowTimes() const override;
+
+    size_t stateSize() const override;
+    void init(Span<double> p_states) const override;
+    void observe(size_t p_date, Span<const double> p_spots, Span<double> p_states) const override;
+    size_t finish(Span<const double> p_states, size_t p_path, Span<CashFlow> p_flows) const override;
+
+private:
+    double m_delivery;
+    double m_localFloor;
+    double m_localCap;
+    double m_globalFloor;
+    double m_globalCap;
+    double m_notional;
+};
+
+//! \brief The common attributes of the Asian options whose payoff is known at compile time, c.f. \a AsianOption.
+//! The payoff is held by value, so for a final \p PayoffType its evaluation inlines into the cash-flows, and a final product
+//! held by value inlines into the static \a Engine in turn.
+template <typename PayoffType>
+class StaticAsianOption : public PathDependent
+{
+public:
+    //! \brief StaticAsianOption
+    //! \param p_lookAtTimes: The averaging times.
+    //! \param p_delivery:  The expiry date can be different from the last averaging date.
+    //! \param p_payoff:    The simple payoff/option this option is composed of, i.e. vanilla call etc.
+    StaticAsianOption(const std::vector<double> & p_lookAtTimes, double p_delivery, PayoffType p_payoff);
+
+    size_t maxNumberOfCashFlows() const override;
+    std::vector<double> possibleCashFlowTimes() const override;
+
+protected:
+    double m_delivery;
+    PayoffType m_payoff;
+};
+
+//! \brief Arithmetic Asian option with the payoff known at compile time, c.f. \a AsianOptionArith.
+template <typename PayoffType>
+class StaticAsianOptionArith final : public StaticAsianOption<PayoffType>
+{
+public:
+    using StaticAsianOption<PayoffType>::StaticAsianOption;
+
+    std::unique_ptr<PathDependent> clone() const override;
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+};
+
+//! \brief Geometric Asian option with the payoff known at compile time, c.f. \a AsianOptionGeom.
+template <typename PayoffType>
+class StaticAsianOptionGeom final : public StaticAsianOption<PayoffType>
+{
+public:
+    using StaticAsianOption<PayoffType>::StaticAsianOption;
+
+    std::unique_ptr<PathDependent> clone() const override;
+    size_t cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const override;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// StaticAsianOption
+
+template <typename PayoffType>
+StaticAsianOption<PayoffType>::StaticAsianOption(const std::vector<double> & p_lookAtTimes, double p_delivery, PayoffType p_payoff)
+    : PathDependent(p_lookAtTimes), m_delivery(p_delivery), m_payoff(std::move(p_payoff))
+{}
+
+template <typename PayoffType>
+size_t StaticAsianOption<PayoffType>::maxNumberOfCashFlows() const
+{
+    return 1;
+}
+
+template <typename PayoffType>
+std::vector<double> StaticAsianOption<PayoffType>::possibleCashFlowTimes() const
+{
+    return {this->m_delivery};
+}
+
+// StaticAsianOptionArith
+
+template <typename PayoffType>
+std::unique_ptr<PathDependent> StaticAsianOptionArith<PayoffType>::clone() const
+{
+    return std::make_unique<StaticAsianOptionArith>(*this);
+}
+
+template <typename PayoffType>
+size_t StaticAsianOptionArith<PayoffType>::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    double sum = std::accumulate(p_spots.begin(), p_spots.end(), 0.0);
+
+    p_flows[0].timeIndex = 0;
+    // the payoff is a function of the arithmetic average
+    p_flows[0].amount = this->m_payoff(sum / this->m_lookAtTimes.size());
+    return 1;
+}
+
+// StaticAsianOptionGeom
+
+template <typename PayoffType>
+std::unique_ptr<PathDependent> StaticAsianOptionGeom<PayoffType>::clone() const
+{
+    return std::make_unique<StaticAsianOptionGeom>(*this);
+}
+
+template <typename PayoffType>
+size_t StaticAsianOptionGeom<PayoffType>::cashFlows(const std::vector<double> & p_spots, Span<CashFlow> p_flows) const
+{
+    // summing the logs: the product of the spots would overflow over a few hundred dates
+    double sumLog =
+        std::accumulate(p_spots.begin(), p_spots.end(), 0.0, [](double p_sum, double p_spot) { return p_sum + std::log(p_spot); });
+
+    p_flows[0].timeIndex = 0;
+    // the payoff is a function of the geometric average
+    p_flows[0].amount = this->m_payoff(std::exp(sumLog / static_cast<double>(this->m_lookAtTimes.size())));
+    return 1;
+}
+
 } // namespace der
 
 #endif // PATHDEPENDENT_H
@@ -3,26 +3,115 @@
  * \date 2/2019
  */
 
-#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
 
+#include "derivatives.h"
 #include "payoff.h"
 
 namespace der
 {
 
+namespace
+{
+
+void checkSizes(Span<const double> p_spots, Span<double> p_payoffs)
+{
+    if (p_spots.size() != p_payoffs.size())
+    {
+        throw std::invalid_argument("Payoff::discountedPayoffs: the spots & the payoffs differ in size.");
+    }
+}
+
+//! \brief The loop for a concrete, i.e. final, payoff: its evaluation is inlined & vectorized.
+template <typename ConcretePayoff>
+void discountedPayoffsOf(const ConcretePayoff & p_payoff, Span<const double> p_spots, double p_discount, Span<double> p_payoffs)
+{
+    checkSizes(p_spots, p_payoffs);
+
+    const double * spots = p_spots.data();
+    double * payoffs = p_payoffs.data();
+
+#pragma omp simd
+    for (size_t i = 0; i < p_spots.size(); ++i)
+    {
+        payoffs[i] = p_discount * p_payoff(spots[i]);
+    }
+}
+
+} // namespace
+
 Payoff::~Payoff() = default;
 
+double Payoff::lognormalExpectation(double /*p_forward*/, double /*p_stdev*/) const
+{
+    throw std::logic_error("Payoff::lognormalExpectation: no closed form available for this payoff.");
+}
+
+double Payoff::derivative(double /*p_spot*/) const
+{
+    throw std::logic_error("Payoff::derivative: no derivative available for this payoff.");
+}
+
+void Payoff::discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    checkSizes(p_spots, p_payoffs);
+
+    for (size_t i = 0; i < p_spots.size(); ++i)
+    {
+        p_payoffs[i] = p_discount * (*this)(p_spots[i]);
+    }
+}
+
+aad::Number Payoff::operator()(const aad::Number & p_spot) const
+{
+    return aad::Number::unary(p_spot, (*this)(p_spot.value()), derivative(p_spot.value()));
+}
+
 PayoffCall::PayoffCall(double p_strike) : m_strike(p_strike) {}
 
 std::unique_ptr<Payoff> PayoffCall::clone() const { return std::make_unique<PayoffCall>(*this); }
 
-double PayoffCall::operator()(double p_spot) const { return std::max<double>(p_spot - m_strike, 0.0); }
+double PayoffCall::lognormalExpectation(double p_forward, double p_stdev) const
+{
+    if (p_stdev <= 0.0)
+    {
+        return (*this)(p_forward);
+    }
+
+    double d1 = (std::log(p_forward / m_strike) + 0.5 * p_stdev * p_stdev) / p_stdev;
+    return p_forward * cumulativeGaussian(d1) - m_strike * cumulativeGaussian(d1 - p_stdev);
+}
+
+double PayoffCall::derivative(double p_spot) const { return p_spot > m_strike ? 1.0 : 0.0; }
+
+void PayoffCall::discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    discountedPayoffsOf(*this, p_spots, p_discount, p_payoffs);
+}
 
 PayoffPut::PayoffPut(double p_strike) : m_strike(p_strike) {}
 
 std::unique_ptr<Payoff> PayoffPut::clone() const { return std::make_unique<PayoffPut>(*this); }
 
-double PayoffPut::operator()(double p_spot) const { return std::max<double>(m_strike - p_spot, 0.0); }
+double PayoffPut::lognormalExpectation(double p_forward, double p_stdev) const
+{
+    if (p_stdev <= 0.0)
+    {
+        return (*this)(p_forward);
+    }
+
+    double d1 = (std::log(p_forward / m_strike) + 0.5 * p_stdev * p_stdev) / p_stdev;
+    return m_strike * cumulativeGaussian(p_stdev - d1) - p_forward * cumulativeGaussian(-d1);
+}
+
+double PayoffPut::derivative(double p_spot) const { return p_spot < m_strike ? -1.0 : 0.0; }
+
+void PayoffPut::discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    discountedPayoffsOf(*this, p_spots, p_discount, p_payoffs);
+}
 
 PayoffDoubleDigital::PayoffDoubleDigital(double lowerLevel, double upperLevel)
     : m_lowerLevel(lowerLevel), m_upperLevel(upperLevel)
@@ -30,12 +119,37 @@ PayoffDoubleDigital::PayoffDoubleDigital(double lowerLevel, double upperLevel)
 
 std::unique_ptr<Payoff> PayoffDoubleDigital::clone() const { return std::make_unique<PayoffDoubleDigital>(*this); }
 
-double PayoffDoubleDigital::operator()(double spot) const { return (spot <= m_upperLevel && spot >= m_lowerLevel) ? 1.0 : 0.0; }
+double PayoffDoubleDigital::lognormalExpectation(double p_forward, double p_stdev) const
+{
+    if (p_stdev <= 0.0)
+    {
+        return (*this)(p_forward);
+    }
+
+    // the probability of finishing between the levels: N(d2(lower)) - N(d2(upper))
+    auto d2 = [&](double p_level) { return (std::log(p_forward / p_level) - 0.5 * p_stdev * p_stdev) / p_stdev; };
+    return cumulativeGaussian(d2(m_lowerLevel)) - cumulativeGaussian(d2(m_upperLevel));
+}
+
+// NOTE: flat between the jumps - pathwise Greeks are useless here, use likelihood ratios instead.
+double PayoffDoubleDigital::derivative(double /*p_spot*/) const { return 0.0; }
+
+void PayoffDoubleDigital::discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    discountedPayoffsOf(*this, p_spots, p_discount, p_payoffs);
+}
 
 PayoffForward::PayoffForward(double p_strike) : m_strike(p_strike) {}
 
 std::unique_ptr<Payoff> PayoffForward::clone() const { return std::make_unique<PayoffForward>(*this); }
 
-double PayoffForward::operator()(double p_spot) const { return p_spot - m_strike; }
+double PayoffForward::lognormalExpectation(double p_forward, double /*p_stdev*/) const { return p_forward - m_strike; }
+
+double PayoffForward::derivative(double /*p_spot*/) const { return 1.0; }
+
+void PayoffForward::discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    discountedPayoffsOf(*this, p_spots, p_discount, p_payoffs);
+}
 
 } // namespace der
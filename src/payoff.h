@@ -8,8 +8,12 @@
 #ifndef PAYOFF2_H
 #define PAYOFF2_H
 
+#include <algorithm>
 #include <memory>
 
+#include "aad.h"
+#include "span.h"
+
 // NOTE: these are registered in payoffregistration.cpp.
 
 namespace der
@@ -29,36 +33,75 @@ public:
     virtual std::unique_ptr<Payoff> clone() const = 0;
     //! \brief Calculates the payoff.
     virtual double operator()(double p_spot) const = 0;
+
+    //! \brief The expectation of the payoff of a log-normally distributed spot, i.e. the undiscounted Black price.
+    //! Not every payoff has a closed form; the default implementation throws.
+    //! \param p_forward - The expectation of the spot.
+    //! \param p_stdev - The standard deviation of the log of the spot.
+    //! \return
+    virtual double lognormalExpectation(double p_forward, double p_stdev) const;
+    //! \brief The derivative of the payoff w.r.t. the spot, used for pathwise Greeks.
+    //! Where the payoff is discontinuous, this is the derivative almost everywhere, which misses the jumps.
+    //! The default implementation throws.
+    //! \param p_spot
+    //! \return
+    virtual double derivative(double p_spot) const;
+    //! \brief Calculates the discounted payoffs of an array of spots, e.g. of a batch of paths, in a single call.
+    //! The concrete payoffs override it with a loop the compiler inlines their evaluation into & vectorizes.
+    //! Throws std::invalid_argument if the sizes differ.
+    //! \param p_spots
+    //! \param p_discount - The factor applied to each payoff.
+    //! \param p_payoffs - May be \p p_spots.
+    virtual void discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const;
+
+    //! \brief Calculates the payoff on the \a aad::Tape, as a single node whose partial is \a derivative.
+    //! Derived classes bring it into scope with a using-declaration, lest their double overload hides it.
+    //! \param p_spot
+    //! \return
+    aad::Number operator()(const aad::Number & p_spot) const;
 };
 
+// NOTE: the concrete payoffs are final & their evaluation inline, so that it inlines wherever the static type is known,
+// e.g. in the products of staticengine.h.
+
 //! \brief Implementation for calls.
-class PayoffCall : public Payoff
+class PayoffCall final : public Payoff
 {
 public:
     PayoffCall(double p_strike);
 
+    using Payoff::operator();
+
     std::unique_ptr<Payoff> clone() const override;
     double operator()(double p_spot) const override;
+    double lognormalExpectation(double p_forward, double p_stdev) const override;
+    double derivative(double p_spot) const override;
+    void discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const override;
 
 private:
     double m_strike = 0;
 };
 
 //! \brief Implementation for puts.
-class PayoffPut : public Payoff
+class PayoffPut final : public Payoff
 {
 public:
     PayoffPut(double p_strike);
 
+    using Payoff::operator();
+
     std::unique_ptr<Payoff> clone() const override;
     double operator()(double p_spot) const override;
+    double lognormalExpectation(double p_forward, double p_stdev) const override;
+    double derivative(double p_spot) const override;
+    void discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const override;
 
 private:
     double m_strike = 0;
 };
 
 //! \brief Implementation for double digital options.
-class PayoffDoubleDigital : public Payoff
+class PayoffDoubleDigital final : public Payoff
 {
 public:
     //! \brief PayoffDoubleDigital
@@ -66,8 +109,13 @@ public:
     //! \param upperLevel - the upper knockout boundary
     PayoffDoubleDigital(double lowerLevel, double upperLevel);
 
+    using Payoff::operator();
+
     std::unique_ptr<Payoff> clone() const override;
     double operator()(double spot) const override;
+    double lognormalExpectation(double p_forward, double p_stdev) const override;
+    double derivative(double p_spot) const override;
+    void discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const override;
 
 private:
     double m_lowerLevel;
@@ -75,19 +123,37 @@ private:
 };
 
 //! \brief Implementation for a simple Forward.
-class PayoffForward : public Payoff
+class PayoffForward final : public Payoff
 {
 
 public:
     PayoffForward(double p_strike);
+
+    using Payoff::operator();
+
     virtual std::unique_ptr<Payoff> clone() const override;
 
     virtual double operator()(double p_spot) const override;
+    virtual double lognormalExpectation(double p_forward, double p_stdev) const override;
+    virtual double derivative(double p_spot) const override;
+    virtual void discountedPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const override;
 
 private:
     double m_strike = 0;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline double PayoffCall::operator()(double p_spot) const { return std::max<double>(p_spot - m_strike, 0.0); }
+
+inline double PayoffPut::operator()(double p_spot) const { return std::max<double>(m_strike - p_spot, 0.0); }
+
+inline double PayoffDoubleDigital::operator()(double spot) const { return (spot <= m_upperLevel && spot >= m_lowerLevel) ? 1.0 : 0.0; }
+
+inline double PayoffForward::operator()(double p_spot) const { return p_spot - m_strike; }
+
 } // namespace der
 
 #endif // PAYOFF2_H
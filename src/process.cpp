@@ -0,0 +1,34 @@
+/** \file process.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <tuple>
+#include <utility>
+
+#include "process.h"
+
+namespace der
+{
+
+BSProcess::BSProcess(std::vector<double> p_times, const Parameters & p_r, const Parameters & p_d, const Parameters & p_vol,
+                     double p_S0)
+    : m_times(std::move(p_times))
+    , m_logS0(std::log(p_S0))
+    , m_drifts(m_times.size())
+    , m_stds(m_times.size())
+    , m_volIntegrals(m_times.size())
+{
+    // pre-calculate the drifts and the standard deviations
+    double previous = 0.0;
+    for (size_t i = 0; i < m_times.size(); ++i)
+    {
+        std::tie(m_drifts[i], m_stds[i]) = step(p_r.integral(previous, m_times[i]) - p_d.integral(previous, m_times[i]),
+                                                p_vol.integralSquare(previous, m_times[i]));
+        m_volIntegrals[i] = p_vol.integral(previous, m_times[i]);
+
+        previous = m_times[i];
+    }
+}
+
+} // namespace der
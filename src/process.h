@@ -0,0 +1,137 @@
+/** \file process.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Stochastic processes for the spot, evolved over fixed dates.
+ */
+
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "aad.h"
+#include "parameters.h"
+
+namespace der
+{
+
+//! \brief The Black-Scholes (i.e. log-Wiener) process for the spot, evolved exactly over the dates given.
+//! The drifts and the standard deviations of the steps are pre-calculated, so a path is an exponential per date.
+//! It is the process of \a ExoticBSEngine and a \p Process of the static \a Engine, c.f. staticengine.h, which requires:
+//! a constructor from the look-at times & the interest rate followed by the process' own arguments, \a dimension and \a evolve.
+class BSProcess
+{
+public:
+    //! \brief Constructor.
+    //! \param p_times - The dates to evolve over, e.g. a product's look-at times.
+    //! \param p_r - The interest rate.
+    //! \param p_d - The dividend rate.
+    //! \param p_vol - The volatility.
+    //! \param p_S0 - The spot @ time 0.
+    BSProcess(std::vector<double> p_times, const Parameters & p_r, const Parameters & p_d, const Parameters & p_vol, double p_S0);
+
+    //! \brief The number of gaussians driving a path, one per date.
+    size_t dimension() const;
+
+    //! \brief Evolves the process over the dates, driven by the gaussians provided.
+    //! \param p_gaussians - One per date.
+    //! \return The spots, overwriting \p p_gaussians in-place.
+    std::vector<double> evolve(std::vector<double> && p_gaussians) const;
+
+    const std::vector<double> & times() const;
+    //! \brief The drifts of the log-spot over the steps.
+    const std::vector<double> & drifts() const;
+    //! \brief The standard deviations of the log-spot over the steps.
+    const std::vector<double> & stds() const;
+    //! \brief The integrals of the vol over the steps, i.e. half the sensitivity of the variances to a parallel vol shift.
+    const std::vector<double> & volIntegrals() const;
+    double logS0() const;
+
+    //! \brief The drift & the standard deviation of the log-spot over a step, on plain doubles or on the \a aad::Tape.
+    //! \param p_carry - The integral of the interest rate less the dividend rate over the step.
+    //! \param p_variance - The integral of the squared vol over the step.
+    //! \return The drift & the standard deviation.
+    template <typename Number>
+    static std::pair<Number, Number> step(const Number & p_carry, const Number & p_variance);
+
+    //! \brief Evolves the log-spot from \p p_logS0 over the steps, on plain doubles or on the \a aad::Tape.
+    //! \param p_logS0
+    //! \param p_drifts - One per step, c.f. \a step.
+    //! \param p_stds - One per step, c.f. \a step.
+    //! \param p_gaussians - One per step.
+    //! \param p_spots - Sized to the steps, may be \p p_gaussians itself.
+    template <typename Number>
+    static void evolvePath(const Number & p_logS0, const std::vector<Number> & p_drifts, const std::vector<Number> & p_stds,
+                           const std::vector<double> & p_gaussians, std::vector<Number> & p_spots);
+
+private:
+    std::vector<double> m_times;
+    double m_logS0;
+
+    // pre-calculated
+    std::vector<double> m_drifts;
+    std::vector<double> m_stds;
+    std::vector<double> m_volIntegrals;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// NOTE: inline, as it is the per-path work of the engines
+
+inline size_t BSProcess::dimension() const { return m_times.size(); }
+
+inline std::vector<double> BSProcess::evolve(std::vector<double> && p_gaussians) const
+{
+    // overwrites the gaussian spots in-place with the BS spots
+    evolvePath(m_logS0, m_drifts, m_stds, p_gaussians, p_gaussians);
+
+    return std::move(p_gaussians);
+}
+
+template <typename Number>
+std::pair<Number, Number> BSProcess::step(const Number & p_carry, const Number & p_variance)
+{
+    using std::sqrt;
+
+    // a deterministic step: on the tape, avoid the infinite derivative of the square root @ 0
+    Number stdDev = aad::value(p_variance) > 0.0 ? sqrt(p_variance) : Number(0.0);
+
+    return {p_carry - 0.5 * p_variance, stdDev};
+}
+
+template <typename Number>
+void BSProcess::evolvePath(const Number & p_logS0, const std::vector<Number> & p_drifts, const std::vector<Number> & p_stds,
+                           const std::vector<double> & p_gaussians, std::vector<Number> & p_spots)
+{
+    using std::exp;
+
+    Number logS = p_logS0;
+
+    // each gaussian is read before its spot is written, hence the aliasing is fine
+    for (size_t i = 0; i < p_drifts.size(); ++i)
+    {
+        logS += p_drifts[i];
+        logS += p_stds[i] * p_gaussians[i];
+
+        p_spots[i] = exp(logS);
+    }
+}
+
+inline const std::vector<double> & BSProcess::times() const { return m_times; }
+
+inline const std::vector<double> & BSProcess::drifts() const { return m_drifts; }
+
+inline const std::vector<double> & BSProcess::stds() const { return m_stds; }
+
+inline const std::vector<double> & BSProcess::volIntegrals() const { return m_volIntegrals; }
+
+inline double BSProcess::logS0() const { return m_logS0; }
+
+} // namespace der
+
+#endif // PROCESS_H
@@ -11,16 +11,14 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <random>
 #include <stdexcept>
 #include <vector>
 
-#ifdef DUMPINTERMEDIATE
-#include <filesystem>
-#include <fstream>
-#endif
-
 #include "derivatives.h"
+#include "samplesink.h"
 
 // Decided on static polymorphism here instead of dynamic,
 // since we usually know the desired generator at compile time
@@ -132,13 +130,132 @@ private:
     static std::random_device m_rDev;
     // not static since we want different instances, e.g. with different seeds
     mutable std::mt19937_64 m_rng;
-    static std::normal_distribution<double> m_normalDist;
+    // not static: it caches every other variate, which is part of the generator's state when copying or replaying
+    mutable std::normal_distribution<double> m_normalDist;
     static std::uniform_int_distribution<size_t> m_uniformDist;
 
     double m_reciprocal = 1. / (1. + max());
 };
 
+//! \brief The xoshiro256+ generator of Blackman & Vigna, run as \p s_lanes interleaved streams for bulk doubles.
+//! The lanes are updated in lock-step by plain loops over arrays, which the compiler maps onto SIMD registers. The uniforms are built
+//! from the top 52 bits by setting the exponent directly, without integer-to-double conversions, and lie on the open interval (0, 1).
+//! The lanes are 2^128 draws apart, c.f. \a jump; \a longJump provides non-overlapping streams for parallel workers.
+//! The output does not depend on how the draws are split into calls.
+template <size_t DIM>
+class RandomXoshiro : public RandomBase<RandomXoshiro<DIM>, DIM>
+{
+public:
+    RandomXoshiro(long p_seed = 1);
+
+    std::vector<double> uniforms(std::vector<double> && p_variates) const;
+
+    //! \brief Skips the next \p p_nPaths variates.
+    void skip(size_t p_nPaths);
+    void setSeed(size_t p_seed);
+    void reset();
+
+    //! @name Additional interface
+    ///@{
+
+    //! \brief Advances each lane by \f$2^{128}\f$ draws.
+    void jump();
+    //! \brief Advances each lane by \f$2^{192}\f$ draws: applied \p k times, it gives the \p k-th of \f$2^{64}\f$ parallel streams.
+    void longJump();
+    ///@}
+
+    static constexpr size_t s_lanes = 8;
+
+private:
+    //! \brief Advances all the lanes by one step, writing the uniforms to \p p_out.
+    void step(double * p_out) const;
+    //! \brief The linear transition of a single lane.
+    void advance(size_t p_lane) const;
+    //! \brief Applies a jump polynomial to a single lane.
+    void jump(size_t p_lane, const std::uint64_t (&p_polynomial)[4]);
+
+    //! \brief The jump polynomials of the authors, for \f$2^{128}\f$ & \f$2^{192}\f$ steps.
+    static constexpr std::uint64_t s_jump[4] = {UINT64_C(0x180EC6D33CFD0ABA), UINT64_C(0xD5A61266F0C9392C),
+                                                UINT64_C(0xA9582618E03FC9AA), UINT64_C(0x39ABDC4529B1661C)};
+    static constexpr std::uint64_t s_longJump[4] = {UINT64_C(0x76E15D3EFEFDCBBF), UINT64_C(0xC5004E441C522FB3),
+                                                    UINT64_C(0x77710069854EE241), UINT64_C(0x39109BB02ACBE635)};
+
+    long m_initSeed;
+
+    //! \brief The states, word-major so that each word of all the lanes is contiguous.
+    alignas(64) mutable std::uint64_t m_state[4][s_lanes];
+    //! \brief The draws of a step not handed out yet.
+    mutable double m_pending[s_lanes];
+    mutable size_t m_nPending{0};
+};
+
+//! \brief A Ziggurat gaussian sampler on top of the uniforms of \p Generator, after Marsaglia & Tsang, as amended by Doornik.
+//! 128 layers: each draw is a uniform, a table look-up & a multiplication in ~98.8% of the cases, with no transcendentals.
+//! The tables are built at compile time. The layer & the abscissa are taken from the top 7 & the remaining bits of a single uniform.
+//! The uniforms are drawn from \p Generator in bulk.
+template <typename Generator, size_t DIM>
+class Ziggurat : public RandomBase<Ziggurat<Generator, DIM>, DIM>
+{
+public:
+    Ziggurat();
+    explicit Ziggurat(long p_seed);
+
+    //! \brief The uniforms of \p Generator, passed through.
+    std::vector<double> uniforms(std::vector<double> && p_variates) const;
+    //! \brief Bulk: fills the whole of \p p_variates in one call.
+    std::vector<double> gaussians(std::vector<double> && p_variates) const;
+
+    //! \brief Skips the next \p p_nPaths gaussians.
+    void skip(size_t p_nPaths);
+    void setSeed(size_t p_seed);
+    void reset();
+
+    //! @name Additional interface
+    ///@{
+
+    //! \brief Generates a single gaussian.
+    double gaussian() const;
+    ///@}
+
+private:
+    static constexpr size_t s_layers = 128;
+    //! \brief The start of the tail.
+    static constexpr double s_R = 3.442619855899;
+    //! \brief The area of each layer.
+    static constexpr double s_V = 9.91256303526217e-3;
+    static constexpr size_t s_bufferSize = 1024;
+
+    //! \brief The layer abscissae \p x & their ratios \p r = x[i + 1] / x[i].
+    struct Tables
+    {
+        double x[s_layers + 1];
+        double r[s_layers];
+    };
+
+    //! @name Compile-time maths, as the std functions are not constexpr
+    ///@{
+    static constexpr double constExp(double p_x);
+    static constexpr double constLog(double p_x);
+    static constexpr double constSqrt(double p_x);
+    ///@}
+
+    static constexpr Tables buildTables();
+    static constexpr Tables s_tables = buildTables();
+
+    //! \brief The next uniform in the buffer, refilled in bulk.
+    double uniform() const;
+    //! \brief Samples the tail beyond \p s_R.
+    double tail(bool p_negative) const;
+
+    Generator m_generator;
+
+    mutable std::vector<double> m_uniforms;
+    mutable size_t m_next;
+};
+
 //! \brief Implements Anti-Thetic sampling using on top of \p Generator.
+//! Every other call mirrors the previous one, \f$u \rightarrow 1 - u\f$ or \f$z \rightarrow -z\f$, in the caller's buffer.
+//! The previous draws are kept in a buffer that is reused, so there is no heap traffic in the steady state.
 template <typename Generator, size_t DIM>
 class AntiThetic : public RandomBase<AntiThetic<Generator, DIM>, DIM>
 {
@@ -147,16 +264,32 @@ public:
     explicit AntiThetic(long p_seed);
 
     std::vector<double> uniforms(std::vector<double> && p_variates) const;
+    //! \brief Gaussian numbers, drawn directly from \p Generator, e.g. using its own fast path.
+    std::vector<double> gaussians(std::vector<double> && p_variates) const;
+
+    //! \brief Block mode: both halves of the antithetic pairs in a single batch, independently of the previous calls.
+    //! The first half are fresh gaussians, the second half their negation, so path \f$i\f$ of the batch is paired with path
+    //! \f$n/2 + i\f$. Handing whole batches to the threads keeps the pairs together.
+    //! \param p_variates - Of an even size.
+    std::vector<double> gaussianPairs(std::vector<double> && p_variates) const;
 
     void skip(size_t p_nPaths);
     void setSeed(size_t p_seed);
     void reset();
 
 protected:
+    //! \brief What \p m_last holds, i.e. whether the next call of the kind mirrors it.
+    enum class Pending
+    {
+        None,
+        Uniforms,
+        Gaussians
+    };
+
     Generator m_generator;
 
     mutable std::vector<double> m_last;
-    mutable bool useAT{false};
+    mutable Pending m_pending{Pending::None};
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -178,21 +311,7 @@ std::vector<double> RandomBase<Derived, DIM>::gaussians(std::vector<double> && p
     // NOTE: here we provide a default implementation, can of course still be overloaded in the derived class
     auto && ret = uniforms(std::move(p_variates));
     std::for_each(ret.begin(), ret.end(), [](auto & el) { el = inverseCumulativeGaussian(el); });
-
-#ifdef DUMPINTERMEDIATE
-    std::filesystem::path dataDir{"../data"};
-    if (!std::filesystem::exists(dataDir))
-    {
-        std::filesystem::create_directory(dataDir);
-    }
-    std::ofstream f{"../data/gaussians"};
-    for (auto it = ret.begin(); it != ret.end() - 1; ++it)
-    {
-        f << *it << ", ";
-    }
-
-    f << *(ret.end() - 1);
-#endif
+    SampleSink::dump(SampleSink::Channel::Gaussians, ret.data(), ret.size());
 
     return std::move(ret);
 }
@@ -234,21 +353,7 @@ template <size_t DIM>
 std::vector<double> RandomParkMiller<DIM>::uniforms(std::vector<double> && p_variates) const
 {
     std::for_each(p_variates.begin(), p_variates.end(), [this](auto & el) { el = randInt() * m_reciprocal; });
-
-#ifdef DUMPINTERMEDIATE
-    std::filesystem::path dataDir{"../data"};
-    if (!std::filesystem::exists(dataDir))
-    {
-        std::filesystem::create_directory(dataDir);
-    }
-    std::ofstream f{"../data/uniforms"};
-    for (auto it = p_variates.begin(); it != p_variates.end() - 1; ++it)
-    {
-        f << *it << ", ";
-    }
-
-    f << *(p_variates.end() - 1);
-#endif
+    SampleSink::dump(SampleSink::Channel::Uniforms, p_variates.data(), p_variates.size());
 
     return std::move(p_variates);
 }
@@ -256,7 +361,7 @@ std::vector<double> RandomParkMiller<DIM>::uniforms(std::vector<double> && p_var
 template <size_t DIM>
 void RandomParkMiller<DIM>::skip(size_t p_nPaths)
 {
-    for (size_t i; i < p_nPaths; ++i)
+    for (size_t i = 0; i < p_nPaths; ++i)
     {
         randInt();
     }
@@ -309,8 +414,6 @@ std::random_device MersenneTwister<DIM>::m_rDev;
 
 template <size_t DIM>
 std::uniform_int_distribution<size_t> MersenneTwister<DIM>::m_uniformDist;
-template <size_t DIM>
-std::normal_distribution<double> MersenneTwister<DIM>::m_normalDist;
 
 template <size_t DIM>
 MersenneTwister<DIM>::MersenneTwister(long p_seed) : m_rng((p_seed == -1) ? m_rDev() : p_seed)
@@ -321,6 +424,7 @@ template <size_t DIM>
 std::vector<double> MersenneTwister<DIM>::uniforms(std::vector<double> && p_variates) const
 {
     std::for_each(p_variates.begin(), p_variates.end(), [this](auto & el) { el = m_uniformDist(m_rng) * m_reciprocal; });
+    SampleSink::dump(SampleSink::Channel::Uniforms, p_variates.data(), p_variates.size());
     return std::move(p_variates);
 }
 
@@ -328,6 +432,7 @@ template <size_t DIM>
 std::vector<double> MersenneTwister<DIM>::gaussians(std::vector<double> && p_variates) const
 {
     std::for_each(p_variates.begin(), p_variates.end(), [this](auto & el) { el = m_normalDist(m_rng); });
+    SampleSink::dump(SampleSink::Channel::Gaussians, p_variates.data(), p_variates.size());
     return std::move(p_variates);
 }
 
@@ -341,12 +446,14 @@ template <size_t DIM>
 void MersenneTwister<DIM>::setSeed(size_t p_seed)
 {
     m_rng.seed(p_seed);
+    m_normalDist.reset();
 }
 
 template <size_t DIM>
 void MersenneTwister<DIM>::reset()
 {
     m_rng.seed();
+    m_normalDist.reset();
 }
 
 template <size_t DIM>
@@ -368,6 +475,389 @@ long MersenneTwister<DIM>::randInt() const
 }
 
 
+// RandomXoshiro
+
+template <size_t DIM>
+RandomXoshiro<DIM>::RandomXoshiro(long p_seed) : m_initSeed(p_seed)
+{
+    setSeed(static_cast<size_t>(p_seed));
+}
+
+template <size_t DIM>
+std::vector<double> RandomXoshiro<DIM>::uniforms(std::vector<double> && p_variates) const
+{
+    double * out = p_variates.data();
+    size_t n = p_variates.size();
+
+    // the leftovers of the previous call first
+    size_t fromPending = std::min(n, m_nPending);
+    std::copy(m_pending + (s_lanes - m_nPending), m_pending + (s_lanes - m_nPending + fromPending), out);
+    m_nPending -= fromPending;
+    out += fromPending;
+    n -= fromPending;
+
+    // whole steps directly into the output
+    for (; n >= s_lanes; n -= s_lanes, out += s_lanes)
+    {
+        step(out);
+    }
+
+    if (n > 0)
+    {
+        step(m_pending);
+        std::copy(m_pending, m_pending + n, out);
+        m_nPending = s_lanes - n;
+    }
+
+    SampleSink::dump(SampleSink::Channel::Uniforms, p_variates.data(), p_variates.size());
+    return std::move(p_variates);
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::step(double * p_out) const
+{
+    auto & s = m_state;
+
+    for (size_t l = 0; l < s_lanes; ++l)
+    {
+        std::uint64_t result = s[0][l] + s[3][l];
+
+        // 1 + the top 52 bits as the mantissa, shifted by half an ulp off 0: ((result >> 12) + 1/2) 2^-52
+        std::uint64_t bits = (result >> 12) | UINT64_C(0x3FF0000000000000);
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        p_out[l] = d - (1.0 - 0x1.0p-53);
+
+        advance(l);
+    }
+}
+
+template <size_t DIM>
+inline void RandomXoshiro<DIM>::advance(size_t p_lane) const
+{
+    auto & s = m_state;
+
+    std::uint64_t t = s[1][p_lane] << 17;
+    s[2][p_lane] ^= s[0][p_lane];
+    s[3][p_lane] ^= s[1][p_lane];
+    s[1][p_lane] ^= s[2][p_lane];
+    s[0][p_lane] ^= s[3][p_lane];
+    s[2][p_lane] ^= t;
+    s[3][p_lane] = (s[3][p_lane] << 45) | (s[3][p_lane] >> 19);
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::skip(size_t p_nPaths)
+{
+    size_t fromPending = std::min(p_nPaths, m_nPending);
+    m_nPending -= fromPending;
+    p_nPaths -= fromPending;
+
+    for (; p_nPaths >= s_lanes; p_nPaths -= s_lanes)
+    {
+        step(m_pending);
+    }
+
+    if (p_nPaths > 0)
+    {
+        step(m_pending);
+        m_nPending = s_lanes - p_nPaths;
+    }
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::setSeed(size_t p_seed)
+{
+    // the first lane is seeded by splitmix64, as recommended by the authors
+    std::uint64_t x = p_seed;
+    for (auto & word : m_state)
+    {
+        x += UINT64_C(0x9E3779B97F4A7C15);
+        std::uint64_t z = x;
+        z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+        z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+        word[0] = z ^ (z >> 31);
+    }
+
+    // each next lane is the previous one jumped
+    for (size_t l = 1; l < s_lanes; ++l)
+    {
+        for (auto & word : m_state)
+        {
+            word[l] = word[l - 1];
+        }
+        jump(l, s_jump);
+    }
+
+    m_nPending = 0;
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::reset()
+{
+    setSeed(static_cast<size_t>(m_initSeed));
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::jump()
+{
+    for (size_t l = 0; l < s_lanes; ++l)
+    {
+        jump(l, s_jump);
+    }
+    m_nPending = 0;
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::longJump()
+{
+    for (size_t l = 0; l < s_lanes; ++l)
+    {
+        jump(l, s_longJump);
+    }
+    m_nPending = 0;
+}
+
+template <size_t DIM>
+void RandomXoshiro<DIM>::jump(size_t p_lane, const std::uint64_t (&p_polynomial)[4])
+{
+    auto & s = m_state;
+    std::uint64_t jumped[4] = {0, 0, 0, 0};
+
+    // multiplies the state by the jump polynomial, stepping the lane alone
+    for (std::uint64_t word : p_polynomial)
+    {
+        for (int b = 0; b < 64; ++b)
+        {
+            if (word & (UINT64_C(1) << b))
+            {
+                for (size_t w = 0; w < 4; ++w)
+                {
+                    jumped[w] ^= s[w][p_lane];
+                }
+            }
+
+            advance(p_lane);
+        }
+    }
+
+    for (size_t w = 0; w < 4; ++w)
+    {
+        s[w][p_lane] = jumped[w];
+    }
+}
+
+// Ziggurat
+
+template <typename Generator, size_t DIM>
+Ziggurat<Generator, DIM>::Ziggurat() : m_uniforms(s_bufferSize), m_next(s_bufferSize)
+{}
+
+template <typename Generator, size_t DIM>
+Ziggurat<Generator, DIM>::Ziggurat(long p_seed) : m_generator(p_seed), m_uniforms(s_bufferSize), m_next(s_bufferSize)
+{}
+
+template <typename Generator, size_t DIM>
+std::vector<double> Ziggurat<Generator, DIM>::uniforms(std::vector<double> && p_variates) const
+{
+    return m_generator.uniforms(std::move(p_variates));
+}
+
+template <typename Generator, size_t DIM>
+std::vector<double> Ziggurat<Generator, DIM>::gaussians(std::vector<double> && p_variates) const
+{
+    for (auto & el : p_variates)
+    {
+        el = gaussian();
+    }
+
+    SampleSink::dump(SampleSink::Channel::Gaussians, p_variates.data(), p_variates.size());
+    return std::move(p_variates);
+}
+
+template <typename Generator, size_t DIM>
+void Ziggurat<Generator, DIM>::skip(size_t p_nPaths)
+{
+    // the number of uniforms consumed per gaussian varies, hence no shortcut
+    for (size_t i = 0; i < p_nPaths; ++i)
+    {
+        gaussian();
+    }
+}
+
+template <typename Generator, size_t DIM>
+void Ziggurat<Generator, DIM>::setSeed(size_t p_seed)
+{
+    m_generator.setSeed(p_seed);
+    m_next = s_bufferSize;
+}
+
+template <typename Generator, size_t DIM>
+void Ziggurat<Generator, DIM>::reset()
+{
+    m_generator.reset();
+    m_next = s_bufferSize;
+}
+
+template <typename Generator, size_t DIM>
+double Ziggurat<Generator, DIM>::gaussian() const
+{
+    while (true)
+    {
+        // the top 7 bits select the layer, the rest is the abscissa in (-1, 1)
+        double scaled = uniform() * s_layers;
+        auto i = static_cast<size_t>(scaled) & (s_layers - 1);
+        double u = 2.0 * (scaled - std::floor(scaled)) - 1.0;
+
+        // inside the rectangle of the layer
+        if (std::abs(u) < s_tables.r[i])
+        {
+            return u * s_tables.x[i];
+        }
+
+        if (i == 0)
+        {
+            return tail(u < 0.0);
+        }
+
+        // in the wedge between the rectangle & the density
+        double x = u * s_tables.x[i];
+        double f0 = std::exp(-0.5 * (s_tables.x[i] * s_tables.x[i] - x * x));
+        double f1 = std::exp(-0.5 * (s_tables.x[i + 1] * s_tables.x[i + 1] - x * x));
+        if (f1 + uniform() * (f0 - f1) < 1.0)
+        {
+            return x;
+        }
+    }
+}
+
+template <typename Generator, size_t DIM>
+double Ziggurat<Generator, DIM>::uniform() const
+{
+    if (m_next == m_uniforms.size())
+    {
+        m_uniforms = m_generator.uniforms(std::move(m_uniforms));
+        m_next = 0;
+    }
+
+    return m_uniforms[m_next++];
+}
+
+template <typename Generator, size_t DIM>
+double Ziggurat<Generator, DIM>::tail(bool p_negative) const
+{
+    // Marsaglia's tail method
+    double x, y;
+    do
+    {
+        x = std::log(uniform()) / s_R;
+        y = std::log(uniform());
+    } while (-2.0 * y < x * x);
+
+    return p_negative ? x - s_R : s_R - x;
+}
+
+template <typename Generator, size_t DIM>
+constexpr double Ziggurat<Generator, DIM>::constExp(double p_x)
+{
+    constexpr double ln2 = 0.693147180559945309417;
+
+    // exp(x) = 2^k exp(r), |r| <= ln2 / 2
+    auto k = static_cast<long>(p_x / ln2 + (p_x >= 0.0 ? 0.5 : -0.5));
+    double r = p_x - k * ln2;
+
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 30; ++n)
+    {
+        term *= r / n;
+        sum += term;
+    }
+
+    for (; k > 0; --k)
+    {
+        sum *= 2.0;
+    }
+    for (; k < 0; ++k)
+    {
+        sum /= 2.0;
+    }
+
+    return sum;
+}
+
+template <typename Generator, size_t DIM>
+constexpr double Ziggurat<Generator, DIM>::constLog(double p_x)
+{
+    constexpr double ln2 = 0.693147180559945309417;
+
+    // x = m 2^k, m in [1, 2)
+    long k = 0;
+    for (; p_x >= 2.0; ++k)
+    {
+        p_x /= 2.0;
+    }
+    for (; p_x < 1.0; --k)
+    {
+        p_x *= 2.0;
+    }
+
+    // log(m) = 2 atanh(s), s = (m - 1) / (m + 1) <= 1/3
+    double s = (p_x - 1.0) / (p_x + 1.0);
+    double sum = 0.0;
+    double term = s;
+    for (int n = 1; n < 80; n += 2)
+    {
+        sum += term / n;
+        term *= s * s;
+    }
+
+    return k * ln2 + 2.0 * sum;
+}
+
+template <typename Generator, size_t DIM>
+constexpr double Ziggurat<Generator, DIM>::constSqrt(double p_x)
+{
+    if (p_x <= 0.0)
+    {
+        return 0.0;
+    }
+
+    // Newton, from above
+    double ret = p_x > 1.0 ? p_x : 1.0;
+    for (int n = 0; n < 100; ++n)
+    {
+        ret = 0.5 * (ret + p_x / ret);
+    }
+
+    return ret;
+}
+
+template <typename Generator, size_t DIM>
+constexpr typename Ziggurat<Generator, DIM>::Tables Ziggurat<Generator, DIM>::buildTables()
+{
+    Tables ret{};
+
+    double f = constExp(-0.5 * s_R * s_R);
+    // the base layer includes the tail: its "width" is the one of a rectangle of area V
+    ret.x[0] = s_V / f;
+    ret.x[1] = s_R;
+    ret.x[s_layers] = 0.0;
+
+    for (size_t i = 2; i < s_layers; ++i)
+    {
+        ret.x[i] = constSqrt(-2.0 * constLog(s_V / ret.x[i - 1] + f));
+        f = constExp(-0.5 * ret.x[i] * ret.x[i]);
+    }
+
+    for (size_t i = 0; i < s_layers; ++i)
+    {
+        ret.r[i] = ret.x[i + 1] / ret.x[i];
+    }
+
+    return ret;
+}
+
 // AntiThetic
 
 template <typename Generator, size_t DIM>
@@ -377,27 +867,55 @@ AntiThetic<Generator, DIM>::AntiThetic(long p_seed) : m_generator(p_seed)
 template <typename Generator, size_t DIM>
 std::vector<double> AntiThetic<Generator, DIM>::uniforms(std::vector<double> && p_variates) const
 {
-    // in case cache can be used
-    if (useAT && m_last.size() <= p_variates.size())
+    // the mirror of the previous draws, in-place
+    if (m_pending == Pending::Uniforms && m_last.size() == p_variates.size())
     {
-        useAT = false;
+        m_pending = Pending::None;
+        std::transform(m_last.begin(), m_last.end(), p_variates.begin(), [](auto el) { return 1.0 - el; });
+        return std::move(p_variates);
+    }
+
+    m_pending = Pending::Uniforms;
+    p_variates = m_generator.uniforms(std::move(p_variates));
+    // a no-op on the capacity after the first call
+    m_last.assign(p_variates.begin(), p_variates.end());
 
-        // this resizes m_last to 0, cheaper to copy than to resize @ every step
-        // return std::move(m_last);
-        decltype(m_last) ret(p_variates.size());
-        std::copy(m_last.begin(), m_last.begin() + p_variates.size(), ret.begin());
-        return ret;
+    return std::move(p_variates);
+}
+
+template <typename Generator, size_t DIM>
+std::vector<double> AntiThetic<Generator, DIM>::gaussians(std::vector<double> && p_variates) const
+{
+    if (m_pending == Pending::Gaussians && m_last.size() == p_variates.size())
+    {
+        m_pending = Pending::None;
+        std::transform(m_last.begin(), m_last.end(), p_variates.begin(), [](auto el) { return -el; });
+        return std::move(p_variates);
     }
 
-    useAT = true;
-    p_variates = AntiThetic<Generator, DIM>::m_generator.uniforms(std::move(p_variates));
+    m_pending = Pending::Gaussians;
+    p_variates = m_generator.gaussians(std::move(p_variates));
+    m_last.assign(p_variates.begin(), p_variates.end());
+
+    return std::move(p_variates);
+}
 
-    if (m_last.size() != p_variates.size())
+template <typename Generator, size_t DIM>
+std::vector<double> AntiThetic<Generator, DIM>::gaussianPairs(std::vector<double> && p_variates) const
+{
+    if (p_variates.size() % 2 != 0)
     {
-        m_last.resize(p_variates.size());
+        throw std::invalid_argument("AntiThetic::gaussianPairs: the batch must hold whole pairs.");
     }
 
-    std::transform(p_variates.begin(), p_variates.end(), m_last.begin(), [](const auto & el) { return 1.0 - el; });
+    // the resizing stays within the capacity
+    size_t half = p_variates.size() / 2;
+    p_variates.resize(half);
+    p_variates = m_generator.gaussians(std::move(p_variates));
+    p_variates.resize(2 * half);
+
+    std::transform(p_variates.begin(), p_variates.begin() + static_cast<std::ptrdiff_t>(half),
+                   p_variates.begin() + static_cast<std::ptrdiff_t>(half), [](auto el) { return -el; });
 
     return std::move(p_variates);
 }
@@ -405,14 +923,17 @@ std::vector<double> AntiThetic<Generator, DIM>::uniforms(std::vector<double> &&
 template <typename Generator, size_t DIM>
 void AntiThetic<Generator, DIM>::skip(size_t p_nPaths)
 {
+    // only the fresh half of the pairs comes from the generator; a skip realigns on a pair
     m_generator.skip(p_nPaths / 2);
+    m_pending = Pending::None;
 }
 
 
 template <typename Generator, size_t DIM>
 void AntiThetic<Generator, DIM>::setSeed(size_t p_seed)
 {
-    return m_generator.setSeed(p_seed);
+    m_generator.setSeed(p_seed);
+    m_pending = Pending::None;
 }
 
 template <typename Generator, size_t DIM>
@@ -420,7 +941,7 @@ void AntiThetic<Generator, DIM>::reset()
 {
     m_generator.reset();
     m_last.clear();
-    useAT = false;
+    m_pending = Pending::None;
 }
 
 } // namespace der
@@ -0,0 +1,241 @@
+/** \file randomasync.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * A generator adapter producing the variates ahead of time on a separate thread.
+ */
+
+#ifndef RANDOMASYNC_H
+#define RANDOMASYNC_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "random.h"
+
+namespace der
+{
+
+//! \brief Generates the gaussians of \p Generator on a producer thread, ahead of their consumption, so that the generation overlaps
+//! with the pricing. The producer & the consumer share a lock-free single-producer/single-consumer ring of paths.
+//! The producer calls the wrapped generator with the size of the first request, so the variates are exactly those the wrapped
+//! generator would have produced, call for call - even for generators whose output depends on the call sizes, e.g. \a AntiThetic.
+//! All the requests must be of that same size, i.e. one path each.
+//! There is one consumer: the adapter is not to be shared between threads. Neither copyable nor movable, the thread refers to it.
+template <typename Generator, size_t DIM>
+class RandomAsync : public RandomBase<RandomAsync<Generator, DIM>, DIM>
+{
+public:
+    //! \brief Constructor.
+    //! \param p_generator - The wrapped generator.
+    //! \param p_slots - The number of paths the producer may run ahead by.
+    explicit RandomAsync(Generator p_generator = Generator{}, size_t p_slots = 256);
+
+    RandomAsync(const RandomAsync &) = delete;
+    RandomAsync & operator=(const RandomAsync &) = delete;
+    RandomAsync(RandomAsync &&) = delete;
+    RandomAsync & operator=(RandomAsync &&) = delete;
+    ~RandomAsync();
+
+    //! \brief Not buffered, throws std::logic_error: the ring holds gaussians only.
+    std::vector<double> uniforms(std::vector<double> && p_variates) const;
+    //! \brief The next path of gaussians, which is ready unless the producer has fallen behind.
+    //! \param p_variates - Its size must be the same for all the calls.
+    std::vector<double> gaussians(std::vector<double> && p_variates) const;
+
+    //! \brief Skips the next \p p_nPaths variates, a multiple of the path size.
+    void skip(size_t p_nPaths);
+    void setSeed(size_t p_seed);
+    void reset();
+
+private:
+    //! \brief Starts the producer for paths of \p p_dimension gaussians.
+    void start(size_t p_dimension) const;
+    //! \brief Stops the producer & discards the buffered paths.
+    void stop() const;
+    //! \brief The producer's loop.
+    void produce() const;
+
+    //! \brief Blocks until the next path is ready.
+    //! \return The ring slot holding it.
+    size_t nextSlot() const;
+
+    // the generator belongs to the producer while it runs
+    mutable Generator m_generator;
+    size_t m_slots;
+
+    mutable size_t m_dimension{0};
+    mutable std::vector<double> m_ring;
+
+    //! \brief The number of paths produced, written by the producer only.
+    alignas(64) mutable std::atomic<size_t> m_head{0};
+    //! \brief The number of paths consumed, written by the consumer only.
+    alignas(64) mutable std::atomic<size_t> m_tail{0};
+
+    mutable std::atomic<bool> m_stop{false};
+    mutable std::atomic<bool> m_failed{false};
+    mutable std::exception_ptr m_error;
+    mutable std::thread m_producer;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Generator, size_t DIM>
+RandomAsync<Generator, DIM>::RandomAsync(Generator p_generator, size_t p_slots)
+    : m_generator(std::move(p_generator)), m_slots(std::max(p_slots, size_t{1}))
+{}
+
+template <typename Generator, size_t DIM>
+RandomAsync<Generator, DIM>::~RandomAsync()
+{
+    stop();
+}
+
+template <typename Generator, size_t DIM>
+std::vector<double> RandomAsync<Generator, DIM>::uniforms(std::vector<double> && /*p_variates*/) const
+{
+    throw std::logic_error("RandomAsync::uniforms: only gaussians are produced ahead.");
+}
+
+template <typename Generator, size_t DIM>
+std::vector<double> RandomAsync<Generator, DIM>::gaussians(std::vector<double> && p_variates) const
+{
+    if (m_dimension == 0)
+    {
+        start(p_variates.size());
+    }
+    else if (p_variates.size() != m_dimension)
+    {
+        throw std::invalid_argument("RandomAsync::gaussians: the requests must all be of the same size.");
+    }
+
+    size_t slot = nextSlot();
+    auto first = m_ring.begin() + static_cast<std::ptrdiff_t>(slot * m_dimension);
+    std::copy(first, first + static_cast<std::ptrdiff_t>(m_dimension), p_variates.begin());
+
+    // releases the slot to the producer
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    return std::move(p_variates);
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::skip(size_t p_nPaths)
+{
+    if (p_nPaths == 0)
+    {
+        return;
+    }
+    if (m_dimension == 0 || p_nPaths % m_dimension != 0)
+    {
+        throw std::invalid_argument("RandomAsync::skip: can only skip whole paths, after the first one.");
+    }
+
+    for (size_t i = 0; i < p_nPaths / m_dimension; ++i)
+    {
+        nextSlot();
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::setSeed(size_t p_seed)
+{
+    stop();
+    m_generator.setSeed(p_seed);
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::reset()
+{
+    stop();
+    m_generator.reset();
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::start(size_t p_dimension) const
+{
+    m_dimension = p_dimension;
+    m_ring.assign(m_slots * m_dimension, 0.0);
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+    m_failed.store(false, std::memory_order_relaxed);
+
+    m_producer = std::thread(&RandomAsync::produce, this);
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::stop() const
+{
+    if (m_producer.joinable())
+    {
+        m_stop.store(true, std::memory_order_relaxed);
+        m_producer.join();
+    }
+
+    // restarted lazily, by the next request
+    m_dimension = 0;
+}
+
+template <typename Generator, size_t DIM>
+void RandomAsync<Generator, DIM>::produce() const
+{
+    try
+    {
+        std::vector<double> path(m_dimension);
+
+        while (!m_stop.load(std::memory_order_relaxed))
+        {
+            // generated before waiting for a free slot, so that it overlaps with the consumption
+            path = m_generator.gaussians(std::move(path));
+
+            size_t head = m_head.load(std::memory_order_relaxed);
+            while (head - m_tail.load(std::memory_order_acquire) == m_slots)
+            {
+                if (m_stop.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+
+            std::copy(path.begin(), path.end(), m_ring.begin() + static_cast<std::ptrdiff_t>((head % m_slots) * m_dimension));
+            // publishes the slot to the consumer
+            m_head.store(head + 1, std::memory_order_release);
+        }
+    }
+    catch (...)
+    {
+        // handed over to the consumer, c.f. nextSlot
+        m_error = std::current_exception();
+        m_failed.store(true, std::memory_order_release);
+    }
+}
+
+template <typename Generator, size_t DIM>
+size_t RandomAsync<Generator, DIM>::nextSlot() const
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    while (m_head.load(std::memory_order_acquire) == tail)
+    {
+        if (m_failed.load(std::memory_order_acquire))
+        {
+            std::rethrow_exception(m_error);
+        }
+        std::this_thread::yield();
+    }
+
+    return tail % m_slots;
+}
+
+} // namespace der
+
+#endif // RANDOMASYNC_H
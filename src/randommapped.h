@@ -0,0 +1,231 @@
+/** \file randommapped.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * A generator replaying variates recorded in a memory-mapped file.
+ */
+
+#ifndef RANDOMMAPPED_H
+#define RANDOMMAPPED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "derivatives.h"
+#include "mappedfile.h"
+#include "random.h"
+
+namespace der
+{
+
+//! \brief Replays gaussians recorded in a file, which is memory-mapped rather than read.
+//! The file is a \a MappedFile::Header followed by its \p count native-endian doubles.
+//! Makes runs exactly reproducible, at no generation cost. The variates can be consumed without copying through \a gaussianBlock.
+//! Copies share the mapping; parallel workers each take a disjoint \a range of it.
+//! The seed of a recorded stream is its position, c.f. \a setSeed.
+template <size_t DIM>
+class RandomMapped : public RandomBase<RandomMapped<DIM>, DIM>
+{
+public:
+    //! \brief An empty recording, e.g. for engines default-constructing their generators; replace it before use.
+    RandomMapped() = default;
+    //! \brief Maps the gaussians recorded @ \p p_path.
+    //! \param p_path
+    explicit RandomMapped(const std::string & p_path);
+
+    //! \brief Maps the gaussians recorded @ \p p_path, recording \p p_count gaussians of \p p_generator there first, if missing.
+    //! An existing recording is never overwritten: it throws if it holds fewer than \p p_count gaussians.
+    //! \param p_path
+    //! \param p_count
+    //! \param p_generator
+    template <typename Generator>
+    RandomMapped(const std::string & p_path, size_t p_count, Generator p_generator);
+
+    std::vector<double> uniforms(std::vector<double> && p_variates) const;
+    std::vector<double> gaussians(std::vector<double> && p_variates) const;
+
+    //! \brief The next \p p_count gaussians, in place in the mapping - no copying involved.
+    //! Throws std::out_of_range past the end of the \a range.
+    //! \param p_count - e.g. the number of steps of a path.
+    //! \return A pointer to the first of \p p_count gaussians.
+    const double * gaussianBlock(size_t p_count) const;
+
+    //! \brief A generator replaying only the gaussians [\p p_first, \p p_first + \p p_count) of this one, sharing the mapping.
+    //! \param p_first
+    //! \param p_count
+    //! \return
+    RandomMapped range(size_t p_first, size_t p_count) const;
+
+    //! \brief Skips the next \p p_nPaths variates.
+    void skip(size_t p_nPaths);
+    //! \brief Positions the generator @ the \p p_seed-th variate of its range.
+    void setSeed(size_t p_seed);
+    //! \brief Rewinds to the start of the range.
+    void reset();
+
+    //! \brief The number of variates in the range.
+    size_t size() const;
+
+private:
+    RandomMapped(std::shared_ptr<const MappedFile> p_file, const double * p_first, size_t p_count);
+
+    //! \brief Maps & validates the recording.
+    void map(const std::string & p_path);
+    //! \brief Records the gaussians to the file, atomically, via a temporary file in the same directory.
+    template <typename Generator>
+    static void record(const std::string & p_path, size_t p_count, Generator & p_generator);
+
+    static constexpr char s_magic[8] = {'D', 'E', 'R', 'G', 'A', 'U', 'S', 'S'};
+    static constexpr std::uint64_t s_version = 1;
+
+    std::shared_ptr<const MappedFile> m_file;
+    const double * m_first{nullptr};
+    size_t m_count{0};
+
+    mutable size_t m_position{0};
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <size_t DIM>
+RandomMapped<DIM>::RandomMapped(const std::string & p_path)
+{
+    map(p_path);
+}
+
+template <size_t DIM>
+template <typename Generator>
+RandomMapped<DIM>::RandomMapped(const std::string & p_path, size_t p_count, Generator p_generator)
+{
+    if (!std::ifstream{p_path})
+    {
+        record(p_path, p_count, p_generator);
+    }
+
+    map(p_path);
+
+    if (m_count < p_count)
+    {
+        throw std::runtime_error("RandomMapped: " + p_path + " holds fewer variates than requested.");
+    }
+}
+
+template <size_t DIM>
+RandomMapped<DIM>::RandomMapped(std::shared_ptr<const MappedFile> p_file, const double * p_first, size_t p_count)
+    : m_file(std::move(p_file)), m_first(p_first), m_count(p_count)
+{}
+
+template <size_t DIM>
+void RandomMapped<DIM>::map(const std::string & p_path)
+{
+    m_file = std::make_shared<const MappedFile>(p_path);
+
+    MappedFile::Header header;
+    if (!m_file->header(s_magic, s_version, header) || m_file->size() != sizeof(header) + header.count * sizeof(double))
+    {
+        throw std::runtime_error("RandomMapped: " + p_path + " is not a recording of variates.");
+    }
+
+    // the mapping is page-aligned and the header is 64 bytes, so the doubles are properly aligned
+    m_first = reinterpret_cast<const double *>(m_file->data() + sizeof(header));
+    m_count = header.count;
+    m_position = 0;
+
+    m_file->adviseSequential(sizeof(header), m_count * sizeof(double));
+}
+
+template <size_t DIM>
+template <typename Generator>
+void RandomMapped<DIM>::record(const std::string & p_path, size_t p_count, Generator & p_generator)
+{
+    MappedFile::write(p_path, s_magic, s_version, p_count, [&](std::ostream & p_out) {
+        // generated in chunks to bound the memory
+        std::vector<double> chunk;
+        for (size_t done = 0; done < p_count; done += chunk.size())
+        {
+            chunk.resize(std::min(p_count - done, size_t{1} << 16));
+            chunk = p_generator.gaussians(std::move(chunk));
+            p_out.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(double)));
+        }
+    });
+}
+
+template <size_t DIM>
+std::vector<double> RandomMapped<DIM>::uniforms(std::vector<double> && p_variates) const
+{
+    // the recording is of gaussians, map them back
+    const double * block = gaussianBlock(p_variates.size());
+    std::transform(block, block + p_variates.size(), p_variates.begin(), [](double el) { return cumulativeGaussian(el); });
+    return std::move(p_variates);
+}
+
+template <size_t DIM>
+std::vector<double> RandomMapped<DIM>::gaussians(std::vector<double> && p_variates) const
+{
+    const double * block = gaussianBlock(p_variates.size());
+    std::copy(block, block + p_variates.size(), p_variates.begin());
+    return std::move(p_variates);
+}
+
+template <size_t DIM>
+const double * RandomMapped<DIM>::gaussianBlock(size_t p_count) const
+{
+    if (p_count > m_count - m_position)
+    {
+        throw std::out_of_range("RandomMapped: the recording is exhausted.");
+    }
+
+    const double * ret = m_first + m_position;
+    m_position += p_count;
+    return ret;
+}
+
+template <size_t DIM>
+RandomMapped<DIM> RandomMapped<DIM>::range(size_t p_first, size_t p_count) const
+{
+    if (p_first > m_count || p_count > m_count - p_first)
+    {
+        throw std::out_of_range("RandomMapped: the range exceeds the recording.");
+    }
+
+    return RandomMapped(m_file, m_first + p_first, p_count);
+}
+
+template <size_t DIM>
+void RandomMapped<DIM>::skip(size_t p_nPaths)
+{
+    gaussianBlock(p_nPaths);
+}
+
+template <size_t DIM>
+void RandomMapped<DIM>::setSeed(size_t p_seed)
+{
+    if (p_seed > m_count)
+    {
+        throw std::out_of_range("RandomMapped: the position exceeds the recording.");
+    }
+    m_position = p_seed;
+}
+
+template <size_t DIM>
+void RandomMapped<DIM>::reset()
+{
+    m_position = 0;
+}
+
+template <size_t DIM>
+size_t RandomMapped<DIM>::size() const
+{
+    return m_count;
+}
+
+} // namespace der
+
+#endif // RANDOMMAPPED_H
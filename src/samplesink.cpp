@@ -0,0 +1,208 @@
+/** \file samplesink.cpp
+ * \author Andrej Leban
+ * \date 10/2026
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "samplesink.h"
+
+namespace der
+{
+
+namespace
+{
+//! \brief The size of the .npy header, fixed so that it can be rewritten with the final shape in place.
+constexpr size_t s_headerSize = 128;
+
+//! \brief The sinks enabled through \a SampleSink::enable; closed at exit.
+std::array<std::unique_ptr<SampleSink>, 2> s_owned;
+} // namespace
+
+std::array<std::atomic<SampleSink *>, 2> SampleSink::s_channels{};
+
+SampleSink::SampleSink(const std::string & p_path, size_t p_bufferSize, size_t p_maxBuffers)
+    : m_file(std::fopen(p_path.c_str(), "wb")), m_bufferSize(std::max(p_bufferSize, size_t{1})), m_maxBuffers(std::max(p_maxBuffers, size_t{1}))
+{
+    if (m_file == nullptr)
+    {
+        throw std::runtime_error("SampleSink: cannot open " + p_path);
+    }
+
+    writeHeader(0);
+    m_current.reserve(m_bufferSize);
+    m_writer = std::thread(&SampleSink::write, this);
+}
+
+SampleSink::~SampleSink()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+        // nothing sensible to do in a destructor
+    }
+}
+
+void SampleSink::append(const double * p_samples, size_t p_count)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_closing)
+    {
+        throw std::logic_error("SampleSink: appending to a closed sink.");
+    }
+
+    while (p_count > 0)
+    {
+        size_t n = std::min(p_count, m_bufferSize - m_current.size());
+        m_current.insert(m_current.end(), p_samples, p_samples + n);
+        p_samples += n;
+        p_count -= n;
+        m_count += n;
+
+        if (m_current.size() == m_bufferSize)
+        {
+            queueCurrent(lock);
+        }
+    }
+}
+
+void SampleSink::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_closing)
+    {
+        return;
+    }
+
+    queueCurrent(lock);
+    m_queueChanged.wait(lock, [this] { return m_queue.empty() && !m_writing; });
+    // the writer is idle, waiting for the lock
+    std::fflush(m_file);
+}
+
+void SampleSink::close()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_closing)
+        {
+            return;
+        }
+
+        queueCurrent(lock);
+        m_closing = true;
+    }
+    m_queueChanged.notify_all();
+    m_writer.join();
+
+    writeHeader(m_count);
+    bool failed = std::ferror(m_file) != 0;
+    failed |= std::fclose(m_file) != 0;
+    m_file = nullptr;
+
+    if (failed)
+    {
+        throw std::runtime_error("SampleSink: writing the samples failed.");
+    }
+}
+
+size_t SampleSink::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+void SampleSink::enable(Channel p_channel, const std::string & p_path)
+{
+    auto i = static_cast<size_t>(p_channel);
+    disable(p_channel);
+    s_owned[i] = std::make_unique<SampleSink>(p_path);
+    s_channels[i].store(s_owned[i].get(), std::memory_order_release);
+}
+
+void SampleSink::disable(Channel p_channel)
+{
+    auto i = static_cast<size_t>(p_channel);
+    s_channels[i].store(nullptr, std::memory_order_release);
+    s_owned[i].reset();
+}
+
+void SampleSink::write()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_queueChanged.wait(lock, [this] { return !m_queue.empty() || m_closing; });
+        if (m_queue.empty())
+        {
+            // closing & drained
+            return;
+        }
+
+        std::vector<double> buffer = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_writing = true;
+
+        // the file is only ever touched by this thread while it runs
+        lock.unlock();
+        std::fwrite(buffer.data(), sizeof(double), buffer.size(), m_file);
+        buffer.clear();
+        lock.lock();
+
+        // recycled, so there is no allocation in the steady state
+        m_free.push_back(std::move(buffer));
+        m_writing = false;
+        m_queueChanged.notify_all();
+    }
+}
+
+void SampleSink::writeHeader(size_t p_count)
+{
+    // NOTE: assumes a little-endian host
+    std::string dict = "{'descr': '<f8', 'fortran_order': False, 'shape': (" + std::to_string(p_count) + ",), }";
+    // magic, version 1.0 & the little-endian length of the dict, which is space-padded & terminated by a newline
+    constexpr size_t preambleSize = 10;
+    dict.resize(s_headerSize - preambleSize - 1, ' ');
+    dict += '\n';
+
+    const char preamble[preambleSize] = {'\x93', 'N', 'U', 'M', 'P', 'Y', 1, 0, static_cast<char>(dict.size() & 0xff),
+                                         static_cast<char>(dict.size() >> 8)};
+
+    std::fseek(m_file, 0, SEEK_SET);
+    std::fwrite(preamble, 1, preambleSize, m_file);
+    std::fwrite(dict.data(), 1, dict.size(), m_file);
+    std::fseek(m_file, 0, SEEK_END);
+}
+
+void SampleSink::queueCurrent(std::unique_lock<std::mutex> & p_lock)
+{
+    // the back-pressure bounding the memory
+    m_queueChanged.wait(p_lock, [this] { return m_queue.size() < m_maxBuffers; });
+
+    // checked after the wait, since other appenders might have queued it in the meantime
+    if (m_current.empty())
+    {
+        return;
+    }
+
+    m_queue.push_back(std::move(m_current));
+    if (!m_free.empty())
+    {
+        m_current = std::move(m_free.back());
+        m_free.pop_back();
+    }
+    else
+    {
+        m_current = std::vector<double>();
+        m_current.reserve(m_bufferSize);
+    }
+
+    m_queueChanged.notify_all();
+}
+
+} // namespace der
@@ -0,0 +1,119 @@
+/** \file samplesink.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Buffered binary dumps of samples, written in the background.
+ */
+
+#ifndef SAMPLESINK_H
+#define SAMPLESINK_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace der
+{
+
+//! \brief Appends samples to a NumPy .npy file (a 1-d array of doubles), loadable with numpy.load.
+//! The samples are copied into fixed-size buffers, which a background thread writes out. At most \p p_maxBuffers full buffers
+//! are queued, beyond which appending blocks until the writer catches up - the memory stays bounded.
+//! The header holds the final number of samples only after \a close (or destruction).
+//! Appending is thread-safe.
+class SampleSink
+{
+public:
+    //! \brief The sinks the generators of random.h dump to, when enabled.
+    enum class Channel
+    {
+        Uniforms,
+        Gaussians
+    };
+
+    //! \brief Constructor, creates/truncates the file. Throws std::runtime_error if it cannot be opened.
+    //! \param p_path
+    //! \param p_bufferSize - The number of samples per buffer.
+    //! \param p_maxBuffers - The maximum number of full buffers waiting to be written.
+    explicit SampleSink(const std::string & p_path, size_t p_bufferSize = size_t{1} << 16, size_t p_maxBuffers = 8);
+
+    SampleSink(const SampleSink &) = delete;
+    SampleSink & operator=(const SampleSink &) = delete;
+    SampleSink(SampleSink &&) = delete;
+    SampleSink & operator=(SampleSink &&) = delete;
+    ~SampleSink();
+
+    //! \brief Appends \p p_count samples.
+    //! \param p_samples
+    //! \param p_count
+    void append(const double * p_samples, size_t p_count);
+    //! \brief Waits until everything appended so far is written.
+    void flush();
+    //! \brief Flushes, finalizes the header & closes the file. Further appending throws std::logic_error.
+    void close();
+
+    //! \brief The number of samples appended so far.
+    size_t size() const;
+
+    //! @name Channels
+    ///@{
+
+    //! \brief Starts dumping the \p p_channel samples to \p p_path. Not to be called while the generators are in use.
+    static void enable(Channel p_channel, const std::string & p_path);
+    //! \brief Stops dumping the \p p_channel samples, closing the file. Not to be called while the generators are in use.
+    static void disable(Channel p_channel);
+    //! \brief Dumps the samples to the \p p_channel sink, if enabled. Just a load & a branch otherwise.
+    static void dump(Channel p_channel, const double * p_samples, size_t p_count);
+    ///@}
+
+private:
+    //! \brief The background writer.
+    void write();
+    //! \brief Writes the .npy header for \p p_count samples @ the start of the file.
+    void writeHeader(size_t p_count);
+    //! \brief Queues the current buffer, if not empty. Requires \p m_mutex to be held.
+    void queueCurrent(std::unique_lock<std::mutex> & p_lock);
+
+    std::FILE * m_file{nullptr};
+    size_t m_bufferSize;
+    size_t m_maxBuffers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+
+    std::vector<double> m_current;
+    std::deque<std::vector<double>> m_queue;
+    std::vector<std::vector<double>> m_free;
+    //! \brief Whether the writer is busy with a buffer that has left the queue.
+    bool m_writing{false};
+    bool m_closing{false};
+    size_t m_count{0};
+
+    std::thread m_writer;
+
+    static std::array<std::atomic<SampleSink *>, 2> s_channels;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline void SampleSink::dump(Channel p_channel, const double * p_samples, size_t p_count)
+{
+    SampleSink * sink = s_channels[static_cast<size_t>(p_channel)].load(std::memory_order_acquire);
+    if (sink != nullptr)
+    {
+        sink->append(p_samples, p_count);
+    }
+}
+
+} // namespace der
+
+#endif // SAMPLESINK_H
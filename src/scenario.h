@@ -0,0 +1,176 @@
+/** \file scenario.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * Bump & revalue scenarios on common random numbers.
+ */
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "exoticengine.h"
+#include "parallel.h"
+#include "parameters.h"
+#include "pathdependent.h"
+#include "statistics.h"
+
+namespace der
+{
+
+//! \brief The shifts of the market inputs defining a scenario. A default-constructed scenario is the base case.
+struct Scenario
+{
+    //! \brief The relative shift of the spot, i.e. \f$S_0 \rightarrow S_0 (1 + spot)\f$.
+    double spot{0.0};
+    //! \brief The absolute shift of the volatility.
+    double vol{0.0};
+    //! \brief The absolute shift of the interest rate.
+    double rate{0.0};
+    //! \brief The absolute shift of the dividend rate.
+    double dividend{0.0};
+};
+
+//! \brief How the draws are shared among the scenarios.
+enum class ScenarioDraws
+{
+    //! \brief The gaussians of all the paths are generated once & kept in memory: \f$N_{paths} \times N_{dates}\f$ doubles.
+    Cached,
+    //! \brief Each scenario replays a copy of the generator from the same state: no memory, but the generation is repeated.
+    Replayed
+};
+
+//! \brief Evaluates a product under several scenarios with a Black-Scholes process, driving every scenario with the same draws.
+//! The noise of the Monte-Carlo then (mostly) cancels out of the differences between the scenarios, so small bumps are resolved.
+//! Per scenario only the engine's pre-calculation & the path evolution are redone. The scenarios are spread across threads.
+template <typename Generator>
+class ScenarioRunner
+{
+public:
+    //! \brief Constructor.
+    //! \param p_product
+    //! \param p_r - The base interest rate.
+    //! \param p_d - The base dividend rate.
+    //! \param p_vol - The base volatility.
+    //! \param p_S0 - The base spot @ time 0.
+    //! \param p_numberOfPaths
+    //! \param p_draws - Whether the draws are cached or replayed.
+    //! \param p_generator - The prototype generator, its current state determines the draws.
+    ScenarioRunner(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol, double p_S0,
+                   size_t p_numberOfPaths, ScenarioDraws p_draws, Generator p_generator = Generator{});
+
+    //! \brief Evaluates all the scenarios.
+    //! \param p_scenarios
+    //! \param p_gatherer - The prototype gatherer, cloned for each scenario.
+    //! \param p_nThreads - The number of threads to use, at least 1.
+    //! \return The gatherers, in the order of \p p_scenarios.
+    std::vector<std::unique_ptr<StatisticsBase>> run(const std::vector<Scenario> & p_scenarios, const StatisticsBase & p_gatherer,
+                                                     size_t p_nThreads = std::thread::hardware_concurrency()) const;
+
+private:
+    //! \brief Evaluates a single scenario.
+    //! \param p_scenario
+    //! \param p_gatherer
+    void runOne(const Scenario & p_scenario, StatisticsBase & p_gatherer) const;
+
+    std::unique_ptr<PathDependent> m_pProduct;
+
+    Parameters m_r;
+    Parameters m_d;
+    Parameters m_vol;
+    double m_S0;
+
+    size_t m_numberOfPaths;
+    ScenarioDraws m_draws;
+    Generator m_generator;
+
+    //! \brief The number of gaussians per path.
+    size_t m_dimension;
+    //! \brief The cached gaussians, path after path.
+    std::vector<double> m_gaussians;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Generator>
+ScenarioRunner<Generator>::ScenarioRunner(const PathDependent & p_product, Parameters p_r, Parameters p_d, Parameters p_vol,
+                                          double p_S0, size_t p_numberOfPaths, ScenarioDraws p_draws, Generator p_generator)
+    : m_pProduct(p_product.clone())
+    , m_r(std::move(p_r))
+    , m_d(std::move(p_d))
+    , m_vol(std::move(p_vol))
+    , m_S0(p_S0)
+    , m_numberOfPaths(p_numberOfPaths)
+    , m_draws(p_draws)
+    , m_generator(std::move(p_generator))
+    , m_dimension(m_pProduct->lookAtTimes().size())
+{
+    if (m_draws == ScenarioDraws::Cached)
+    {
+        // a copy, so that the draws are the same as a replay's would be
+        Generator generator = m_generator;
+        std::vector<double> gaussians(m_dimension);
+
+        m_gaussians.reserve(m_numberOfPaths * m_dimension);
+        for (size_t path = 0; path < m_numberOfPaths; ++path)
+        {
+            gaussians = generator.gaussians(std::move(gaussians));
+            m_gaussians.insert(m_gaussians.end(), gaussians.begin(), gaussians.end());
+        }
+    }
+}
+
+template <typename Generator>
+std::vector<std::unique_ptr<StatisticsBase>> ScenarioRunner<Generator>::run(const std::vector<Scenario> & p_scenarios,
+                                                                            const StatisticsBase & p_gatherer, size_t p_nThreads) const
+{
+    std::vector<std::unique_ptr<StatisticsBase>> ret;
+    for (size_t i = 0; i < p_scenarios.size(); ++i)
+    {
+        ret.push_back(p_gatherer.clone());
+    }
+
+    parallelFor(p_scenarios.size(), p_nThreads, [&](size_t p_scenario) { runOne(p_scenarios[p_scenario], *ret[p_scenario]); });
+
+    return ret;
+}
+
+template <typename Generator>
+void ScenarioRunner<Generator>::runOne(const Scenario & p_scenario, StatisticsBase & p_gatherer) const
+{
+    // the bumped engine: its construction is the pre-calculation. It gets a copy of the prototype rather than seeding a generator
+    // of its own, which it would not use & which would draw on the generator's shared seed source from the worker threads
+    ExoticBSEngine<Generator> engine(*m_pProduct, ParametersShifted(m_r, p_scenario.rate), ParametersShifted(m_d, p_scenario.dividend),
+                                     ParametersShifted(m_vol, p_scenario.vol), m_S0 * (1.0 + p_scenario.spot), m_generator);
+
+    Generator generator = m_generator;
+    std::vector<double> spots(m_dimension);
+
+    for (size_t path = 0; path < m_numberOfPaths; ++path)
+    {
+        if (m_draws == ScenarioDraws::Cached)
+        {
+            auto first = m_gaussians.begin() + static_cast<std::ptrdiff_t>(path * m_dimension);
+            std::copy(first, first + static_cast<std::ptrdiff_t>(m_dimension), spots.begin());
+        }
+        else
+        {
+            spots = generator.gaussians(std::move(spots));
+        }
+
+        spots = engine.evolve(std::move(spots));
+        p_gatherer.dumpOneResult(engine.doOnePath(spots));
+    }
+}
+
+} // namespace der
+
+#endif // SCENARIO_H
@@ -4,24 +4,34 @@
  */
 
 #include "simspot.h"
+#include "simdmath.h"
 
 namespace der
 {
 
 simSpot::simSpot(double p_S0, double p_t, double p_sigma, double p_r)
-    : m_t(p_t), m_sigma(p_sigma), m_precalc(p_S0 * std::exp((p_r - 0.5 * p_sigma * p_sigma) * p_t))
+    : m_t(p_t), m_sigma(p_sigma), m_precalc(p_S0 * std::exp((p_r - 0.5 * p_sigma * p_sigma) * p_t)),
+      m_rootVariance(p_sigma * std::sqrt(p_t))
 {}
 
-double simSpot::operator()() const { return m_precalc * std::exp(m_sigma * std::sqrt(m_t) * normalDist<double>()); }
+double simSpot::operator()() const { return m_precalc * std::exp(m_rootVariance * normalDist<double>()); }
 
 simSpotParams::simSpotParams(double p_S0, double p_t, const der::Parameters & p_sigma, const der::Parameters & p_r)
-    : m_t(p_t), m_sigma(p_sigma), m_precalc(p_S0 * std::exp(p_r.integral(0, p_t) - 0.5 * p_sigma.integralSquare(0, p_t)))
+    : m_t(p_t), m_sigma(p_sigma), m_precalc(p_S0 * std::exp(p_r.integral(0, p_t) - 0.5 * p_sigma.integralSquare(0, p_t))),
+      m_rootVariance(std::sqrt(p_sigma.integralSquare(0, p_t)))
 {}
 
-double simSpotParams::operator()() const
+double simSpotParams::operator()() const { return m_precalc * std::exp(m_rootVariance * normalDist<double>()); }
+
+void lognormalSpots(double p_precalc, double p_rootVariance, Span<double> p_values)
 {
-    // need root variance, sqrt(t) already factored in
-    return m_precalc * std::exp(sqrt(m_sigma.integralSquare(0, m_t)) * normalDist<double>());
+    double * values = p_values.data();
+
+#pragma omp simd
+    for (size_t i = 0; i < p_values.size(); ++i)
+    {
+        values[i] = p_precalc * simd::exp(p_rootVariance * values[i]);
+    }
 }
 
 } // namespace der
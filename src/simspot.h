@@ -14,6 +14,7 @@
 
 #include "derivatives.h"
 #include "parameters.h"
+#include "span.h"
 
 namespace der
 {
@@ -31,6 +32,8 @@ struct simSpot
     double m_t;
     double m_sigma;
     double m_precalc;
+    //! \brief \f$\sigma\sqrt{t}\f$
+    double m_rootVariance;
 };
 
 //! \brief The simSpotParams struct
@@ -47,8 +50,16 @@ struct simSpotParams
     double m_t{0.0};
     Parameters m_sigma;
     double m_precalc{0.0};
+    //! \brief \f$\sqrt{\int_0^t \sigma^2}\f$, sqrt(t) already factored in
+    double m_rootVariance{0.0};
 };
 
+//! \brief Maps gaussians to spot values in place, \f$S_0 e^{\mu + s z}\f$: a fused, vectorized kernel, c.f. simdmath.h.
+//! \param p_precalc - \f$S_0 e^{\mu}\f$, \f$\mu\f$ the drift of the log of the spot.
+//! \param p_rootVariance - \f$s\f$
+//! \param p_values - The gaussians on input, the spot values on output.
+void lognormalSpots(double p_precalc, double p_rootVariance, Span<double> p_values);
+
 //! \brief The simSpotParamsMultiple struct also simulates a number of spot values
 //! Allows a compile-time selection of a RNG, in addition to generic Parameters
 template <typename Generator = std::nullptr_t>
@@ -70,6 +81,11 @@ struct simSpotParamsMultiple : public simSpotParams
     //! \param p_nValues
     //! \return a vector sized \p p_nValues of simulated spot values
     std::vector<double> simSpotMultiple(size_t p_nValues);
+    //! \brief Overload reusing the storage of \p p_values, e.g. across the batches of a simulation.
+    //! The gaussians are drawn in bulk, then mapped to spots by \a lognormalSpots.
+    //! \param p_values - Pre-allocated to the desired size.
+    //! \return \p p_values, of simulated spot values
+    std::vector<double> simSpotMultiple(std::vector<double> && p_values);
 
     ///! \note In case no generator is provided - the built-in is used, this can store an initial seed value.
     mutable Generator m_generator;
@@ -101,16 +117,16 @@ double simSpotParamsMultiple<Generator>::operator()() const
     {
         if constexpr (std::is_same<Generator, std::nullptr_t>::value)
         {
-            return m_precalc * std::exp(sqrt(m_sigma.integralSquare(0, m_t)) * normalDist<double>());
+            return m_precalc * std::exp(m_rootVariance * normalDist<double>());
         }
         else if constexpr (std::is_same<Generator, size_t>::value)
         { // this is the seed, only used once
-            return m_precalc * std::exp(sqrt(m_sigma.integralSquare(0, m_t)) * normalDist<double>(m_generator));
+            return m_precalc * std::exp(m_rootVariance * normalDist<double>(m_generator));
         }
         // make use of custom generator
         else
         {
-            return m_precalc * std::exp(sqrt(m_sigma.integralSquare(0, m_t)) * m_generator.gaussians(std::vector<double>(1)));
+            return m_precalc * std::exp(m_rootVariance * m_generator.gaussians(std::vector<double>(1))[0]);
         }
     }
 }
@@ -118,25 +134,28 @@ double simSpotParamsMultiple<Generator>::operator()() const
 template <typename Generator>
 std::vector<double> simSpotParamsMultiple<Generator>::simSpotMultiple(size_t p_nValues)
 {
-    std::vector<double> ret(p_nValues);
+    return simSpotMultiple(std::vector<double>(p_nValues));
+}
 
+template <typename Generator>
+std::vector<double> simSpotParamsMultiple<Generator>::simSpotMultiple(std::vector<double> && p_values)
+{
     if constexpr (std::is_same<Generator, std::nullptr_t>::value)
     {
-        std::for_each(ret.begin(), ret.end(), [this](auto & el) { el = (*this)(); });
-        return ret;
+        std::generate(p_values.begin(), p_values.end(), []() { return normalDist<double>(); });
+    }
+    else if constexpr (std::is_same<Generator, size_t>::value)
+    {
+        std::generate(p_values.begin(), p_values.end(), [this]() { return normalDist<double>(m_generator); });
     }
-
     else
     {
-        ret = m_generator.gaussians(std::move(ret));
-        for (auto & el : ret)
-        {
-            el *= std::sqrt(m_sigma.integralSquare(0, m_t));
-            el = m_precalc * std::exp(el);
-        }
-
-        return ret;
+        p_values = m_generator.gaussians(std::move(p_values));
     }
+
+    lognormalSpots(m_precalc, m_rootVariance, p_values);
+
+    return std::move(p_values);
 }
 
 } // namespace der
@@ -8,8 +8,12 @@
 #ifndef DER_SOLVER_H
 #define DER_SOLVER_H
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
+#include <tuple>
+#include <utility>
 
 //NOTE: Remove this coupling if type checking is not desired for Newton's method.
 #include <type_traits>
@@ -18,10 +22,53 @@
 namespace der
 {
 
+//! \brief Root finding for expensive functions, e.g. a full pricing run per evaluation, counting the iterations & the evaluations.
+//! Brent's method needs a bracket only; the safeguarded Newton's method also the derivative, which the function returns along with
+//! its value so that the two share an evaluation. Both never leave the bracket & converge superlinearly on smooth functions.
+//! The searches may stop on the value, c.f. \a Solver(), which spares the evaluations spent on resolving the root further.
 class Solver
 {
 public:
-    Solver() = default;
+    //! \brief Constructor.
+    //! \param p_xTolerance - The absolute tolerance on the solution.
+    //! \param p_yTolerance - The absolute tolerance on the value, reaching either ends the search. 0 to use \p p_xTolerance only.
+    //! \param p_maxIterations
+    explicit Solver(double p_xTolerance = 1e-8, double p_yTolerance = 0., size_t p_maxIterations = 100);
+
+    //! \brief Solves \p p_function( \p return) = \p p_y via Brent's method: inverse quadratic interpolation, falling back to bisection.
+    //! Throws std::invalid_argument if [\p p_a, \p p_b] does not bracket the solution, std::runtime_error if not converged.
+    //! \param p_y
+    //! \param p_function - Any callable double(double).
+    //! \param p_a - The lower end of the bracket.
+    //! \param p_b - The upper end of the bracket.
+    //! \return The solution.
+    template <typename Function>
+    double brent(double p_y, Function p_function, double p_a, double p_b);
+
+    //! \brief Solves \p p_function( \p return) = \p p_y via Newton's method, safeguarded by bisection whenever a step would leave the
+    //! bracket or fails to halve the value.
+    //! Throws std::invalid_argument if [\p p_a, \p p_b] does not bracket the solution, std::runtime_error if not converged.
+    //! \param p_y
+    //! \param p_function - Any callable returning the value & the derivative as a std::pair<double, double>.
+    //! \param p_x0 - The initial guess, moved to the middle of the bracket if outside.
+    //! \param p_a - The lower end of the bracket.
+    //! \param p_b - The upper end of the bracket.
+    //! \return The solution.
+    template <typename Function>
+    double newton(double p_y, Function p_function, double p_x0, double p_a, double p_b);
+
+    //! \brief The number of iterations of the last search.
+    size_t iterations() const;
+    //! \brief The number of evaluations of the function in the last search, the bracket's included.
+    size_t evaluations() const;
+
+private:
+    double m_xTolerance;
+    double m_yTolerance;
+    size_t m_maxIterations;
+
+    size_t m_iterations{0};
+    size_t m_evaluations{0};
 };
 
 
@@ -102,6 +149,200 @@ double newtonRaphson(double p_y, const Functor & p_functor, double p_x0, double
     return p_x0;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline Solver::Solver(double p_xTolerance, double p_yTolerance, size_t p_maxIterations)
+    : m_xTolerance(p_xTolerance), m_yTolerance(p_yTolerance), m_maxIterations(p_maxIterations)
+{}
+
+template <typename Function>
+double Solver::brent(double p_y, Function p_function, double p_a, double p_b)
+{
+    m_iterations = 0;
+    m_evaluations = 2;
+
+    double a = p_a;
+    double b = p_b;
+    double fa = p_function(a) - p_y;
+    double fb = p_function(b) - p_y;
+
+    if ((fa > 0. && fb > 0.) || (fa < 0. && fb < 0.))
+    {
+        throw std::invalid_argument("Solver::brent: the solution is not bracketed.");
+    }
+
+    // b is the best estimate so far, c the previous one or the other end of the bracket
+    double c = b;
+    double fc = fb;
+    double d = b - a;
+    double e = d;
+
+    for (; m_iterations < m_maxIterations; ++m_iterations)
+    {
+        if ((fb > 0. && fc > 0.) || (fb < 0. && fc < 0.))
+        {
+            // b & c on the same side: c becomes the other end of the bracket
+            c = a;
+            fc = fa;
+            d = b - a;
+            e = d;
+        }
+        if (std::abs(fc) < std::abs(fb))
+        {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        double tol = 2. * std::numeric_limits<double>::epsilon() * std::abs(b) + 0.5 * m_xTolerance;
+        double xm = 0.5 * (c - b);
+        if (std::abs(xm) <= tol || std::abs(fb) <= m_yTolerance || fb == 0.)
+        {
+            return b;
+        }
+
+        if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb))
+        {
+            // the secant or the inverse quadratic interpolation
+            double p, q;
+            double s = fb / fa;
+            if (a == c)
+            {
+                p = 2. * xm * s;
+                q = 1. - s;
+            }
+            else
+            {
+                double qa = fa / fc;
+                double r = fb / fc;
+                p = s * (2. * xm * qa * (qa - r) - (b - a) * (r - 1.));
+                q = (qa - 1.) * (r - 1.) * (s - 1.);
+            }
+            if (p > 0.)
+            {
+                q = -q;
+            }
+            p = std::abs(p);
+
+            // accepted if within the bracket & converging faster than the bisection would
+            if (2. * p < std::min(3. * xm * q - std::abs(tol * q), std::abs(e * q)))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = xm;
+                e = d;
+            }
+        }
+        else
+        {
+            d = xm;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(d) > tol ? d : std::copysign(tol, xm);
+        fb = p_function(b) - p_y;
+        ++m_evaluations;
+    }
+
+    throw std::runtime_error("Solver::brent: no convergence within the maximal number of iterations.");
+}
+
+template <typename Function>
+double Solver::newton(double p_y, Function p_function, double p_x0, double p_a, double p_b)
+{
+    m_iterations = 0;
+    m_evaluations = 2;
+
+    double fa = p_function(p_a).first - p_y;
+    double fb = p_function(p_b).first - p_y;
+
+    if ((fa > 0. && fb > 0.) || (fa < 0. && fb < 0.))
+    {
+        throw std::invalid_argument("Solver::newton: the solution is not bracketed.");
+    }
+    if (std::abs(fa) <= m_yTolerance || fa == 0.)
+    {
+        return p_a;
+    }
+    if (std::abs(fb) <= m_yTolerance || fb == 0.)
+    {
+        return p_b;
+    }
+
+    // the bracket oriented so that the function is negative @ xLow
+    double xLow = fa < 0. ? p_a : p_b;
+    double xHigh = fa < 0. ? p_b : p_a;
+
+    double x = (p_x0 > std::min(p_a, p_b) && p_x0 < std::max(p_a, p_b)) ? p_x0 : 0.5 * (p_a + p_b);
+    double dxOld = std::abs(p_b - p_a);
+    double dx = dxOld;
+
+    auto [f, df] = p_function(x);
+    f -= p_y;
+    ++m_evaluations;
+
+    for (; m_iterations < m_maxIterations; ++m_iterations)
+    {
+        if (std::abs(f) <= m_yTolerance || f == 0.)
+        {
+            return x;
+        }
+
+        dxOld = dx;
+        if (((x - xHigh) * df - f) * ((x - xLow) * df - f) > 0. || std::abs(2. * f) > std::abs(dxOld * df))
+        {
+            // Newton's step would leave the bracket, or is not converging fast enough
+            dx = 0.5 * (xHigh - xLow);
+            x = xLow + dx;
+        }
+        else
+        {
+            dx = f / df;
+            x -= dx;
+        }
+
+        if (std::abs(dx) < m_xTolerance)
+        {
+            return x;
+        }
+
+        std::tie(f, df) = p_function(x);
+        f -= p_y;
+        ++m_evaluations;
+
+        if (f < 0.)
+        {
+            xLow = x;
+        }
+        else
+        {
+            xHigh = x;
+        }
+    }
+
+    throw std::runtime_error("Solver::newton: no convergence within the maximal number of iterations.");
+}
+
+inline size_t Solver::iterations() const
+{
+    return m_iterations;
+}
+
+inline size_t Solver::evaluations() const
+{
+    return m_evaluations;
+}
+
 } // namespace der
 
 #endif // DER_SOLVER_H
@@ -0,0 +1,138 @@
+/** \file span.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * A non-owning view of a contiguous sequence.
+ */
+
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace der
+{
+
+//! \brief A non-owning view of a contiguous sequence of \p T, a stand-in for C++20's std::span.
+//! Lets the callee write into storage the caller owns & sized once, e.g. an engine's cash-flow buffer, so nothing is allocated
+//! or moved per call. Cheap to copy: pass it by value.
+template <typename T>
+class Span
+{
+public:
+    Span() = default;
+    Span(T * p_data, size_t p_size);
+
+    // no explicit since we want implicit conversion
+    template <typename U, typename = std::enable_if_t<std::is_same<std::remove_const_t<T>, U>::value>>
+    Span(std::vector<U> & p_vector);
+    template <typename U, typename = std::enable_if_t<std::is_same<T, const U>::value>>
+    Span(const std::vector<U> & p_vector);
+    //! \brief A read-only view of a mutable span.
+    template <typename U, typename = std::enable_if_t<std::is_same<T, const U>::value>>
+    Span(Span<U> p_other);
+
+    T * data() const;
+    size_t size() const;
+    bool empty() const;
+
+    T & operator[](size_t p_index) const;
+
+    T * begin() const;
+    T * end() const;
+
+    //! \brief The view of \p p_count elements from \p p_offset on; throws std::out_of_range past the end.
+    //! \param p_offset
+    //! \param p_count
+    //! \return
+    Span subspan(size_t p_offset, size_t p_count) const;
+    //! \brief The view of the elements from \p p_offset on.
+    Span subspan(size_t p_offset) const;
+
+private:
+    T * m_data{nullptr};
+    size_t m_size{0};
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+Span<T>::Span(T * p_data, size_t p_size) : m_data(p_data), m_size(p_size)
+{}
+
+template <typename T>
+template <typename U, typename>
+Span<T>::Span(std::vector<U> & p_vector) : m_data(p_vector.data()), m_size(p_vector.size())
+{}
+
+template <typename T>
+template <typename U, typename>
+Span<T>::Span(const std::vector<U> & p_vector) : m_data(p_vector.data()), m_size(p_vector.size())
+{}
+
+template <typename T>
+template <typename U, typename>
+Span<T>::Span(Span<U> p_other) : m_data(p_other.data()), m_size(p_other.size())
+{}
+
+template <typename T>
+T * Span<T>::data() const
+{
+    return m_data;
+}
+
+template <typename T>
+size_t Span<T>::size() const
+{
+    return m_size;
+}
+
+template <typename T>
+bool Span<T>::empty() const
+{
+    return m_size == 0;
+}
+
+template <typename T>
+T & Span<T>::operator[](size_t p_index) const
+{
+    return m_data[p_index];
+}
+
+template <typename T>
+T * Span<T>::begin() const
+{
+    return m_data;
+}
+
+template <typename T>
+T * Span<T>::end() const
+{
+    return m_data + m_size;
+}
+
+template <typename T>
+Span<T> Span<T>::subspan(size_t p_offset, size_t p_count) const
+{
+    if (p_offset > m_size || p_count > m_size - p_offset)
+    {
+        throw std::out_of_range("Span::subspan: the view exceeds the sequence.");
+    }
+    return Span(m_data + p_offset, p_count);
+}
+
+template <typename T>
+Span<T> Span<T>::subspan(size_t p_offset) const
+{
+    return subspan(p_offset, m_size - std::min(p_offset, m_size));
+}
+
+} // namespace der
+
+#endif // SPAN_H
@@ -0,0 +1,157 @@
+/** \file staticengine.h
+ * \author Andrej Leban
+ * \date 10/2026
+ *
+ * An option pricing engine resolved entirely at compile time.
+ */
+
+#ifndef STATICENGINE_H
+#define STATICENGINE_H
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "parameters.h"
+#include "pathdependent.h"
+#include "statistics.h"
+
+namespace der
+{
+
+//! \brief An option pricing engine whose process, product and generator are all static types.
+//! Unlike \a ExoticEngine, where each path goes through the virtual \a ExoticEngine::path, \a PathDependent::cashFlows and
+//! \a Payoff::operator(), here the whole per-path loop is visible to the compiler, to inline and vectorize.
+//! The product is held by value, so its calls are direct; for a final product with a final payoff, e.g.
+//! \a StaticAsianOptionArith<PayoffCall>, so are the payoff's.
+//! \tparam Process - e.g. \a BSProcess: constructible from the look-at times, the interest rate & its own arguments, providing
+//! \a dimension and \a evolve.
+//! \tparam Product - A concrete \a PathDependent.
+//! \tparam Generator - A \a RandomBase generator.
+template <typename Process, typename Product, typename Generator>
+class Engine
+{
+public:
+    //! \brief Constructor.
+    //! \param p_product
+    //! \param p_r - The interest rate.
+    //! \param p_processArgs - The arguments of the process after the interest rate, e.g. the dividend rate, the vol & the spot.
+    template <typename... ProcessArgs>
+    Engine(Product p_product, Parameters p_r, const ProcessArgs &... p_processArgs);
+    //! \brief Constructor with the generator provided, e.g. a \a RandomMapped replaying a recorded run. First, as the process'
+    //! arguments come last.
+    //! \param p_generator - Its current state determines the draws.
+    //! \param p_product
+    //! \param p_r - The interest rate.
+    //! \param p_processArgs - The arguments of the process after the interest rate.
+    template <typename... ProcessArgs>
+    Engine(Generator p_generator, Product p_product, Parameters p_r, const ProcessArgs &... p_processArgs);
+
+    //! \brief Generates the spots of the next path.
+    //! \param p_spots
+    //! \return Modified \p p_spots in-place.
+    std::vector<double> path(std::vector<double> && p_spots) const;
+
+    //! \brief Evaluates one path of the simulation, with the spot values provided.
+    //! \param p_spots
+    //! \return
+    double doOnePath(const std::vector<double> & p_spots) const;
+
+    //! \brief Performs the whole simulation, i.e. evaluates all the paths.
+    //! \param p_gatherer
+    //! \param p_numberOfPaths
+    void doSimulation(StatisticsBase & p_gatherer, size_t p_numberOfPaths) const;
+
+    const Process & process() const;
+    const Product & product() const;
+
+private:
+    Product m_product;
+    Parameters m_r;
+    Process m_process;
+
+    //! \brief The RNG provided.
+    Generator m_generator;
+
+    //! \brief pre-calculated discounts
+    std::vector<double> m_discounts;
+    //! \brief used as scratchpad for in-place calculations, sized once to the product's maximum number of cash-flows
+    mutable std::vector<CashFlow> m_cashflows;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IMPLEMENTATION
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename Process, typename Product, typename Generator>
+template <typename... ProcessArgs>
+Engine<Process, Product, Generator>::Engine(Product p_product, Parameters p_r, const ProcessArgs &... p_processArgs)
+    : Engine(Generator{}, std::move(p_product), std::move(p_r), p_processArgs...)
+{}
+
+template <typename Process, typename Product, typename Generator>
+template <typename... ProcessArgs>
+Engine<Process, Product, Generator>::Engine(Generator p_generator, Product p_product, Parameters p_r,
+                                            const ProcessArgs &... p_processArgs)
+    : m_product(std::move(p_product))
+    , m_r(std::move(p_r))
+    , m_process(m_product.lookAtTimes(), m_r, p_processArgs...)
+    , m_generator(std::move(p_generator))
+    , m_discounts(m_product.possibleCashFlowTimes())
+    , m_cashflows(m_product.maxNumberOfCashFlows())
+{
+    // the cash-flow times get mutated in place to discounts
+    for (auto & discount : m_discounts)
+    {
+        discount = std::exp(-m_r.integral(0.0, discount));
+    }
+}
+
+template <typename Process, typename Product, typename Generator>
+std::vector<double> Engine<Process, Product, Generator>::path(std::vector<double> && p_spots) const
+{
+    return m_process.evolve(m_generator.gaussians(std::move(p_spots)));
+}
+
+template <typename Process, typename Product, typename Generator>
+double Engine<Process, Product, Generator>::doOnePath(const std::vector<double> & p_spots) const
+{
+    size_t nFlows = m_product.cashFlows(p_spots, m_cashflows);
+
+    double val = 0.0;
+    for (size_t k = 0; k < nFlows; ++k)
+    {
+        val += m_cashflows[k].amount * m_discounts[m_cashflows[k].timeIndex];
+    }
+
+    return val;
+}
+
+template <typename Process, typename Product, typename Generator>
+void Engine<Process, Product, Generator>::doSimulation(StatisticsBase & p_gatherer, size_t p_numberOfPaths) const
+{
+    // spots is moved around and reused at each path
+    std::vector<double> spots(m_process.dimension());
+
+    for (size_t i = 0; i < p_numberOfPaths; ++i)
+    {
+        spots = path(std::move(spots));
+        p_gatherer.dumpOneResult(doOnePath(spots));
+    }
+}
+
+template <typename Process, typename Product, typename Generator>
+const Process & Engine<Process, Product, Generator>::process() const
+{
+    return m_process;
+}
+
+template <typename Process, typename Product, typename Generator>
+const Product & Engine<Process, Product, Generator>::product() const
+{
+    return m_product;
+}
+
+} // namespace der
+
+#endif // STATICENGINE_H
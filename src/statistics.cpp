@@ -4,6 +4,9 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 
 #include "statistics.h"
 
@@ -12,6 +15,14 @@ namespace der
 
 StatisticsBase::~StatisticsBase() = default;
 
+void StatisticsBase::dumpResults(Span<const double> p_vals)
+{
+    for (double val : p_vals)
+    {
+        dumpOneResult(val);
+    }
+}
+
 StatisticsMean::StatisticsMean(double runningSum, size_t paths) : m_runningSum(runningSum), m_nPathsDone(paths) {}
 
 std::unique_ptr<StatisticsBase> StatisticsMean::clone() const
@@ -29,6 +40,15 @@ void StatisticsMean::dumpOneResult(double val)
     ++m_nPathsDone;
 }
 
+void StatisticsMean::dumpResults(Span<const double> p_vals)
+{
+    for (double val : p_vals)
+    {
+        m_runningSum += val;
+    }
+    m_nPathsDone += p_vals.size();
+}
+
 ConvergenceTable::~ConvergenceTable() = default;
 
 ConvergenceTable::ConvergenceTable(std::unique_ptr<StatisticsBase> p_pGatherer) : m_pGatherer(std::move(p_pGatherer)) {}
@@ -62,4 +82,263 @@ void ConvergenceTable::dumpOneResult(double val)
     }
 }
 
+void ConvergenceTable::dumpResults(Span<const double> p_vals)
+{
+    for (size_t done = 0; done < p_vals.size();)
+    {
+        size_t count = std::min(p_vals.size() - done, m_count - m_nPathsDone);
+        m_pGatherer->dumpResults(p_vals.subspan(done, count));
+        m_nPathsDone += count;
+        done += count;
+
+        if (m_nPathsDone == m_count)
+        {
+            m_count *= 2;
+            m_results.push_back({static_cast<double>(m_nPathsDone), m_pGatherer->resultsSoFar().back().back()});
+        }
+    }
+}
+
+// StatisticsControlVariate
+
+StatisticsControlVariate::StatisticsControlVariate(double p_controlMean) : m_controlMean(p_controlMean) {}
+
+std::vector<std::vector<double>> StatisticsControlVariate::resultsSoFar() const
+{
+    return {{m_mean - beta() * (m_controlSampleMean - m_controlMean)}};
+}
+
+size_t StatisticsControlVariate::simsSoFar() const { return m_nPathsDone; }
+
+void StatisticsControlVariate::dumpOneResult(double p_val, double p_control)
+{
+    ++m_nPathsDone;
+
+    double delta = p_val - m_mean;
+    double controlDelta = p_control - m_controlSampleMean;
+
+    m_mean += delta / m_nPathsDone;
+    m_controlSampleMean += controlDelta / m_nPathsDone;
+
+    m_m2 += delta * (p_val - m_mean);
+    m_controlM2 += controlDelta * (p_control - m_controlSampleMean);
+    m_coM2 += delta * (p_control - m_controlSampleMean);
+}
+
+double StatisticsControlVariate::beta() const { return m_controlM2 > 0.0 ? m_coM2 / m_controlM2 : 0.0; }
+
+double StatisticsControlVariate::varianceReductionFactor() const
+{
+    if (m_m2 <= 0.0)
+    {
+        return 1.0;
+    }
+
+    double residual = m_m2 - beta() * m_coM2;
+    return residual > 0.0 ? m_m2 / residual : std::numeric_limits<double>::infinity();
+}
+
+// StatisticsMultiple
+
+StatisticsMultiple::~StatisticsMultiple() = default;
+
+// StatisticsMultipleMean
+
+StatisticsMultipleMean::StatisticsMultipleMean(size_t p_nLanes) : m_runningSums(p_nLanes) {}
+
+std::unique_ptr<StatisticsMultiple> StatisticsMultipleMean::clone() const { return std::make_unique<StatisticsMultipleMean>(*this); }
+
+std::vector<std::vector<double>> StatisticsMultipleMean::resultsSoFar() const
+{
+    std::vector<std::vector<double>> ret;
+    for (auto sum : m_runningSums)
+    {
+        ret.push_back({sum / m_nPathsDone});
+    }
+    return ret;
+}
+
+size_t StatisticsMultipleMean::simsSoFar() const { return m_nPathsDone; }
+
+void StatisticsMultipleMean::dumpOneResult(const std::vector<double> & p_vals)
+{
+    std::transform(m_runningSums.begin(), m_runningSums.end(), p_vals.begin(), m_runningSums.begin(), std::plus<>());
+    ++m_nPathsDone;
+}
+
+// StatisticsControlVariates
+
+namespace
+{
+//! \brief Solves the small dense system \p p_A x = \p p_b via Gaussian elimination with partial pivoting.
+//! Singular directions (e.g. duplicate controls) get a zero coefficient.
+std::vector<double> solve(std::vector<double> p_A, std::vector<double> p_b)
+{
+    size_t n = p_b.size();
+
+    // relative to the scale of the system
+    double tol = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        tol = std::max(tol, std::abs(p_A[i * n + i]));
+    }
+    tol *= 1e-12;
+
+    for (size_t col = 0; col < n; ++col)
+    {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < n; ++row)
+        {
+            if (std::abs(p_A[row * n + col]) > std::abs(p_A[pivot * n + col]))
+            {
+                pivot = row;
+            }
+        }
+        for (size_t k = 0; k < n; ++k)
+        {
+            std::swap(p_A[col * n + k], p_A[pivot * n + k]);
+        }
+        std::swap(p_b[col], p_b[pivot]);
+
+        if (std::abs(p_A[col * n + col]) <= tol)
+        {
+            continue;
+        }
+
+        for (size_t row = col + 1; row < n; ++row)
+        {
+            double factor = p_A[row * n + col] / p_A[col * n + col];
+            for (size_t k = col; k < n; ++k)
+            {
+                p_A[row * n + k] -= factor * p_A[col * n + k];
+            }
+            p_b[row] -= factor * p_b[col];
+        }
+    }
+
+    std::vector<double> x(n);
+    for (size_t row = n; row-- > 0;)
+    {
+        if (std::abs(p_A[row * n + row]) <= tol)
+        {
+            continue;
+        }
+
+        double sum = p_b[row];
+        for (size_t k = row + 1; k < n; ++k)
+        {
+            sum -= p_A[row * n + k] * x[k];
+        }
+        x[row] = sum / p_A[row * n + row];
+    }
+
+    return x;
+}
+} // namespace
+
+StatisticsControlVariates::StatisticsControlVariates(size_t p_nLanes, std::vector<std::pair<size_t, double>> p_controls)
+    : m_nLanes(p_nLanes)
+    , m_controls(std::move(p_controls))
+    , m_means(p_nLanes)
+    , m_m2(p_nLanes)
+    , m_coM2(m_controls.size() * p_nLanes)
+    , m_deltas(p_nLanes)
+{}
+
+std::unique_ptr<StatisticsMultiple> StatisticsControlVariates::clone() const
+{
+    return std::make_unique<StatisticsControlVariates>(*this);
+}
+
+std::vector<std::vector<double>> StatisticsControlVariates::resultsSoFar() const
+{
+    std::vector<std::vector<double>> ret(m_nLanes);
+
+    for (size_t lane = 0; lane < m_nLanes; ++lane)
+    {
+        auto beta = betas(lane);
+
+        double estimate = m_means[lane];
+        for (size_t c = 0; c < m_controls.size(); ++c)
+        {
+            estimate -= beta[c] * (m_means[m_controls[c].first] - m_controls[c].second);
+        }
+        ret[lane] = {estimate};
+    }
+
+    return ret;
+}
+
+size_t StatisticsControlVariates::simsSoFar() const { return m_nPathsDone; }
+
+void StatisticsControlVariates::dumpOneResult(const std::vector<double> & p_vals)
+{
+    ++m_nPathsDone;
+
+    // deviations from the old means, then update the means
+    for (size_t lane = 0; lane < m_nLanes; ++lane)
+    {
+        m_deltas[lane] = p_vals[lane] - m_means[lane];
+        m_means[lane] += m_deltas[lane] / m_nPathsDone;
+        m_m2[lane] += m_deltas[lane] * (p_vals[lane] - m_means[lane]);
+    }
+
+    // co-deviations of the controls against all the lanes
+    for (size_t c = 0; c < m_controls.size(); ++c)
+    {
+        double controlDelta = m_deltas[m_controls[c].first];
+        double * row = m_coM2.data() + c * m_nLanes;
+
+        for (size_t lane = 0; lane < m_nLanes; ++lane)
+        {
+            row[lane] += controlDelta * (p_vals[lane] - m_means[lane]);
+        }
+    }
+}
+
+std::vector<double> StatisticsControlVariates::varianceReductionFactors() const
+{
+    std::vector<double> ret(m_nLanes, 1.0);
+
+    for (size_t lane = 0; lane < m_nLanes; ++lane)
+    {
+        if (m_m2[lane] <= 0.0)
+        {
+            continue;
+        }
+
+        // the variance explained by the controls is beta . Cov(Y, X)
+        auto beta = betas(lane);
+        double explained = 0.0;
+        for (size_t c = 0; c < m_controls.size(); ++c)
+        {
+            explained += beta[c] * m_coM2[c * m_nLanes + lane];
+        }
+
+        double residual = m_m2[lane] - explained;
+        ret[lane] = residual > 0.0 ? m_m2[lane] / residual : std::numeric_limits<double>::infinity();
+    }
+
+    return ret;
+}
+
+std::vector<double> StatisticsControlVariates::betas(size_t p_lane) const
+{
+    size_t nControls = m_controls.size();
+
+    std::vector<double> covControls(nControls * nControls);
+    std::vector<double> covTarget(nControls);
+
+    for (size_t i = 0; i < nControls; ++i)
+    {
+        for (size_t j = 0; j < nControls; ++j)
+        {
+            covControls[i * nControls + j] = m_coM2[i * m_nLanes + m_controls[j].first];
+        }
+        covTarget[i] = m_coM2[i * m_nLanes + p_lane];
+    }
+
+    return solve(std::move(covControls), std::move(covTarget));
+}
+
 } // namespace der
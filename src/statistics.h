@@ -8,8 +8,11 @@
 #define STATISTICS_H
 
 #include <memory>
+#include <utility>
 #include <vector>
 
+#include "span.h"
+
 namespace der
 {
 
@@ -33,6 +36,9 @@ public:
     virtual size_t simsSoFar() const = 0;
      //! \brief The input method.
     virtual void dumpOneResult(double val) = 0;
+     //! \brief The input method for a batch of results, e.g. of \a VanillaOption::optionPayoffs: a single call per batch.
+     //! The default implementation dumps them one by one.
+    virtual void dumpResults(Span<const double> p_vals);
 };
 
  //! \brief Just keeps track of the mean.
@@ -52,6 +58,7 @@ public:
     size_t simsSoFar() const override;
      //! \brief The input method.
     void dumpOneResult(double val) override;
+    void dumpResults(Span<const double> p_vals) override;
 
 private:
     double m_runningSum{0.0};
@@ -81,6 +88,8 @@ public:
     size_t simsSoFar() const override;
      //! \brief The input method.
     void dumpOneResult(double val) override;
+     //! \brief Passes the batch on to the aggregated gatherer in parts, split @ the milestones.
+    void dumpResults(Span<const double> p_vals) override;
 
 private:
     std::shared_ptr<StatisticsBase> m_pGatherer{};
@@ -93,6 +102,129 @@ private:
     std::vector<std::vector<double>> m_results{};
 };
 
+//! \brief Gathers paired samples of a target and of a control variate whose expectation is known.
+//! The optimal coefficient \f$\beta = \frac{Cov(X, Y)}{Var(Y)}\f$ is estimated online along with the moments, the estimate is then
+//! \f$\bar{X} - \beta(\bar{Y} - E[Y])\f$.
+class StatisticsControlVariate
+{
+public:
+    //! \brief StatisticsControlVariate
+    //! \param p_controlMean - The known expectation of the control.
+    explicit StatisticsControlVariate(double p_controlMean);
+
+     //! \brief Returns gathered results.
+     //! The inner vector is 1-element in this case: the controlled estimate.
+    std::vector<std::vector<double>> resultsSoFar() const;
+     //! \brief The number of simulations done.
+    size_t simsSoFar() const;
+     //! \brief The input method.
+     //! \param p_val - The target sample.
+     //! \param p_control - The control sample from the same path.
+    void dumpOneResult(double p_val, double p_control);
+
+     //! \brief The estimated optimal coefficient.
+    double beta() const;
+     //! \brief The ratio of the variances of the plain and the controlled estimator: \f$\frac{1}{1 - \rho^2}\f$.
+     //! Equivalently, the factor of paths saved for the same error.
+    double varianceReductionFactor() const;
+
+private:
+    double m_controlMean;
+
+    size_t m_nPathsDone{0};
+    double m_mean{0.0};
+    double m_controlSampleMean{0.0};
+    //! \brief Running sums of the (co-)deviations, updated a la Welford
+    double m_m2{0.0};
+    double m_controlM2{0.0};
+    double m_coM2{0.0};
+};
+
+//! \brief The interface ABC for stats gatherers of vector-valued results, e.g. several products priced on the same paths.
+//! Each component of the result is called a lane.
+class StatisticsMultiple
+{
+public:
+    StatisticsMultiple() = default;
+    StatisticsMultiple(const StatisticsMultiple &) = default;
+    StatisticsMultiple(StatisticsMultiple &&) = default;
+    StatisticsMultiple & operator=(const StatisticsMultiple &) = default;
+    StatisticsMultiple & operator=(StatisticsMultiple &&) = default;
+    virtual ~StatisticsMultiple();
+
+    virtual std::unique_ptr<StatisticsMultiple> clone() const = 0;
+
+     //! \brief Returns gathered results.
+     //! \return a matrix, one row per lane.
+    virtual std::vector<std::vector<double>> resultsSoFar() const = 0;
+     //! \brief The number of simulations done.
+    virtual size_t simsSoFar() const = 0;
+     //! \brief The input method.
+     //! \param p_vals - One value per lane.
+    virtual void dumpOneResult(const std::vector<double> & p_vals) = 0;
+};
+
+ //! \brief Just keeps track of the mean of each lane.
+class StatisticsMultipleMean : public StatisticsMultiple
+{
+public:
+    //! \brief StatisticsMultipleMean
+    //! \param p_nLanes
+    explicit StatisticsMultipleMean(size_t p_nLanes);
+
+    std::unique_ptr<StatisticsMultiple> clone() const override;
+
+     //! \brief Returns gathered results.
+     //! The inner vectors are 1-element in this case.
+    std::vector<std::vector<double>> resultsSoFar() const override;
+    size_t simsSoFar() const override;
+    void dumpOneResult(const std::vector<double> & p_vals) override;
+
+private:
+    std::vector<double> m_runningSums;
+    size_t m_nPathsDone{0};
+};
+
+//! \brief Uses the lanes with a known expectation as control variates for all the others.
+//! For each target lane, the optimal coefficients \f$\beta = Var(Y)^{-1}Cov(Y, X)\f$ w.r.t. the vector of controls \f$Y\f$
+//! are estimated online, c.f. \a StatisticsControlVariate.
+//! The work per path is proportional to the number of lanes times the number of controls.
+class StatisticsControlVariates : public StatisticsMultiple
+{
+public:
+    //! \brief StatisticsControlVariates
+    //! \param p_nLanes
+    //! \param p_controls - Pairs of (lane, known expectation), declaring the lanes to be used as controls.
+    StatisticsControlVariates(size_t p_nLanes, std::vector<std::pair<size_t, double>> p_controls);
+
+    std::unique_ptr<StatisticsMultiple> clone() const override;
+
+     //! \brief Returns gathered results.
+     //! The inner vectors are 1-element in this case: the controlled estimate, or the known expectation for the controls.
+    std::vector<std::vector<double>> resultsSoFar() const override;
+    size_t simsSoFar() const override;
+    void dumpOneResult(const std::vector<double> & p_vals) override;
+
+     //! \brief The ratio of the variances of the plain and the controlled estimator, per lane.
+    std::vector<double> varianceReductionFactors() const;
+
+private:
+    //! \brief The optimal coefficients of the controls for lane \p p_lane
+    std::vector<double> betas(size_t p_lane) const;
+
+    size_t m_nLanes;
+    std::vector<std::pair<size_t, double>> m_controls;
+
+    size_t m_nPathsDone{0};
+    std::vector<double> m_means;
+    //! \brief Running co-deviations, a la Welford: lane variances, and a (controls x lanes) matrix, row-major.
+    std::vector<double> m_m2;
+    std::vector<double> m_coM2;
+
+    //! \brief used as scratchpad for the deviations
+    std::vector<double> m_deltas;
+};
+
 } // namespace der
 
 #endif // STATISTICS_H
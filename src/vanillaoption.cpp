@@ -43,4 +43,9 @@ VanillaOption & VanillaOption::operator=(VanillaOption && p_othr) noexcept
 
 double VanillaOption::optionPayoff(double spot) const { return (*m_pPayoff)(spot); }
 
+void VanillaOption::optionPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const
+{
+    m_pPayoff->discountedPayoffs(p_spots, p_discount, p_payoffs);
+}
+
 } // namespace der
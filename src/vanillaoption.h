@@ -33,6 +33,11 @@ public:
     //! \param spot
     //! \return
     double optionPayoff(double spot) const;
+    //! \brief evaluates the discounted payoffs for an array of spot values, c.f. \a Payoff::discountedPayoffs
+    //! \param p_spots
+    //! \param p_discount
+    //! \param p_payoffs - may be \p p_spots
+    void optionPayoffs(Span<const double> p_spots, double p_discount, Span<double> p_payoffs) const;
 
 private:
     std::unique_ptr<Payoff> m_pPayoff;